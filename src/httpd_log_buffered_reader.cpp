@@ -1,34 +1,214 @@
 #include "httpd_log_buffered_reader.hpp"
+#include "duckdb/common/string_util.hpp"
+#include <bitset>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace duckdb {
 
-HttpdLogBufferedReader::HttpdLogBufferedReader(FileSystem &fs, const string &path) {
-	file_handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ | FileCompressionType::AUTO_DETECT);
-	buffer = make_unsafe_uniq_array_uninitialized<char>(BUFFER_SIZE);
+// Count '\n' bytes in [data, data + size).
+// Processes 8 bytes per step with a branch-free SWAR zero-byte test (exact, no false positives),
+// which compilers turn into packed SIMD compares on every target DuckDB builds for.
+static idx_t CountNewlines(const char *data, idx_t size) {
+	constexpr uint64_t NEWLINES = 0x0A0A0A0A0A0A0A0AULL;
+	constexpr uint64_t LOW_BITS = 0x7F7F7F7F7F7F7F7FULL;
+
+	idx_t count = 0;
+	idx_t pos = 0;
+	for (; pos + sizeof(uint64_t) <= size; pos += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + pos, sizeof(uint64_t));
+		// Bytes equal to '\n' become zero; set the high bit of exactly those bytes
+		uint64_t x = word ^ NEWLINES;
+		uint64_t zero_bytes = ~(((x & LOW_BITS) + LOW_BITS) | x | LOW_BITS);
+		count += std::bitset<64>(zero_bytes).count();
+	}
+	for (; pos < size; pos++) {
+		count += data[pos] == '\n';
+	}
+	return count;
+}
+
+HttpdLogReadBuffer::HttpdLogReadBuffer(optional_ptr<BufferManager> buffer_manager, idx_t capacity_p,
+                                       idx_t alignment)
+    : capacity(capacity_p) {
+	idx_t allocation_size = capacity + alignment;
+	if (buffer_manager) {
+		handle = buffer_manager->Allocate(MemoryTag::EXTENSION, allocation_size);
+		data = char_ptr_cast(handle.Ptr());
+	} else {
+		memory = make_unsafe_uniq_array_uninitialized<char>(allocation_size);
+		data = memory.get();
+	}
+	if (alignment > 0) {
+		auto misalignment = reinterpret_cast<uintptr_t>(data) % alignment;
+		if (misalignment != 0) {
+			data += alignment - misalignment;
+		}
+	}
+}
+
+HttpdLogReadBuffer::HttpdLogReadBuffer(HttpdLogReadBuffer &&other) noexcept
+    : handle(std::move(other.handle)), memory(std::move(other.memory)), data(other.data), capacity(other.capacity) {
+	other.data = nullptr;
+	other.capacity = 0;
+}
+
+HttpdLogReadBuffer &HttpdLogReadBuffer::operator=(HttpdLogReadBuffer &&other) noexcept {
+	handle = std::move(other.handle);
+	memory = std::move(other.memory);
+	data = other.data;
+	capacity = other.capacity;
+	other.data = nullptr;
+	other.capacity = 0;
+	return *this;
+}
+
+HttpdLogBufferedReader::HttpdLogBufferedReader(FileSystem &fs, const string &path, idx_t buffer_capacity_p)
+    : HttpdLogBufferedReader(fs, path, HttpdLogReadBuffer(nullptr, buffer_capacity_p)) {
+}
+
+HttpdLogBufferedReader::HttpdLogBufferedReader(FileSystem &fs, const string &path, HttpdLogReadBuffer buffer_p,
+                                               HttpdLogCacheMode cache_mode, idx_t start_offset,
+                                               shared_ptr<HttpdLogInflateCache> inflate_cache_p)
+    : buffer(std::move(buffer_p)), buffer_capacity(buffer.Capacity()) {
+	bool compressed = IsCompressedPath(path);
+	bool local = !FileSystem::IsRemoteFile(path);
+
+	// Direct I/O needs aligned memory, offsets and sizes: only for whole-buffer sequential reads of plain local files
+	if (cache_mode == HttpdLogCacheMode::DIRECT &&
+	    (compressed || !local || reinterpret_cast<uintptr_t>(buffer.Ptr()) % DIRECT_IO_ALIGNMENT != 0 ||
+	     buffer_capacity % DIRECT_IO_ALIGNMENT != 0)) {
+		cache_mode = HttpdLogCacheMode::DROP_BEHIND;
+	}
+
+	if (cache_mode == HttpdLogCacheMode::DIRECT) {
+		try {
+			file_handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ | FileFlags::FILE_FLAGS_DIRECT_IO);
+		} catch (std::exception &) {
+			// Some file systems (e.g. tmpfs) reject O_DIRECT
+			cache_mode = HttpdLogCacheMode::DROP_BEHIND;
+		}
+	}
+	if (!file_handle) {
+		file_handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ | FileCompressionType::AUTO_DETECT);
+	}
+	// Seek() could move to unaligned offsets
+	seekable = !compressed && file_handle->CanSeek() && cache_mode != HttpdLogCacheMode::DIRECT;
+	// Blocks are cached by their stream offset: only whole-buffer sequential reads of compressed files
+	if (inflate_cache_p && compressed && buffer_capacity == BUFFER_SIZE) {
+		inflate_cache = std::move(inflate_cache_p);
+		inflate_file_id = HttpdLogInflateCache::FileIdentity(fs, *file_handle, path);
+	}
+
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+	if (cache_mode == HttpdLogCacheMode::DROP_BEHIND && local) {
+		// A second descriptor on the same file: advice on the page cache applies to the file, not the descriptor
+		advice_fd = ::open(path.c_str(), O_RDONLY);
+	}
+#endif
+	if (start_offset > 0) {
+		D_ASSERT(seekable);
+		file_handle->Seek(start_offset);
+		buffer_start = start_offset;
+		advised_offset = start_offset;
+	}
 	RefillBuffer();
 }
 
+HttpdLogBufferedReader::~HttpdLogBufferedReader() {
+	CloseAdvice();
+}
+
+void HttpdLogBufferedReader::AdviseConsumed(idx_t end) {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+	if (advice_fd < 0) {
+		return;
+	}
+	if (seekable) {
+		if (end > advised_offset) {
+			posix_fadvise(advice_fd, static_cast<off_t>(advised_offset), static_cast<off_t>(end - advised_offset),
+			              POSIX_FADV_DONTNEED);
+		}
+		// Start reading the next buffer into the page cache while this one is parsed
+		posix_fadvise(advice_fd, static_cast<off_t>(end + buffer_capacity), static_cast<off_t>(buffer_capacity),
+		              POSIX_FADV_WILLNEED);
+	}
+	// Compressed streams: offsets are in the decompressed text, so the file is only dropped when closed
+	advised_offset = end;
+#endif
+}
+
+void HttpdLogBufferedReader::CloseAdvice() {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+	if (advice_fd < 0) {
+		return;
+	}
+	posix_fadvise(advice_fd, 0, 0, POSIX_FADV_DONTNEED);
+	::close(advice_fd);
+	advice_fd = -1;
+#endif
+}
+
+HttpdLogReadBuffer HttpdLogBufferedReader::ReleaseBuffer() {
+	CloseAdvice();
+	file_handle.reset();
+	buffer_offset = 0;
+	buffer_size = 0;
+	eof_reached = true;
+	return std::move(buffer);
+}
+
 void HttpdLogBufferedReader::RefillBuffer() {
+	buffer_start += buffer_size;
+	buffer_offset = 0;
+
 	if (eof_reached) {
 		buffer_size = 0;
 		return;
 	}
 
-	buffer_size = file_handle->Read(buffer.get(), BUFFER_SIZE);
-	buffer_offset = 0;
+	// Everything before buffer_start has been consumed
+	AdviseConsumed(buffer_start);
+
+	buffer_size = ReadBlock();
 
-	if (buffer_size < BUFFER_SIZE) {
+	if (buffer_size < buffer_capacity) {
 		eof_reached = true;
 	}
 }
 
+idx_t HttpdLogBufferedReader::ReadBlock() {
+	if (!inflate_cache) {
+		return NumericCast<idx_t>(file_handle->Read(buffer.Ptr(), buffer_capacity));
+	}
+	auto cached = inflate_cache->Lookup(inflate_file_id, buffer_start);
+	if (cached) {
+		memcpy(buffer.Ptr(), cached->data.get(), cached->size);
+		return cached->size;
+	}
+	// Catch up on the blocks that were copied from the cache (caching them again on the way)
+	while (true) {
+		auto block_start = stream_offset;
+		auto size = NumericCast<idx_t>(file_handle->Read(buffer.Ptr(), buffer_capacity));
+		stream_offset += size;
+		inflate_cache->Insert(inflate_file_id, block_start, buffer.Ptr(), size);
+		if (block_start >= buffer_start || size < buffer_capacity) {
+			return size;
+		}
+	}
+}
+
 bool HttpdLogBufferedReader::ReadLine(string &result) {
 	result.clear();
 
 	while (true) {
 		// バッファ内で改行を探す
 		while (buffer_offset < buffer_size) {
-			char c = buffer[buffer_offset++];
+			char c = buffer.Ptr()[buffer_offset++];
 
 			if (c == '\n') {
 				// 末尾の \r を削除
@@ -51,8 +231,140 @@ bool HttpdLogBufferedReader::ReadLine(string &result) {
 	}
 }
 
+idx_t HttpdLogBufferedReader::CountLines() {
+	if (buffer_offset >= buffer_size) {
+		if (eof_reached) {
+			return 0;
+		}
+		RefillBuffer();
+	}
+
+	idx_t remaining = buffer_size - buffer_offset;
+	if (remaining == 0) {
+		// Empty file, or EOF exactly at a buffer boundary after an unterminated line
+		idx_t lines = at_line_start ? 0 : 1;
+		at_line_start = true;
+		return lines;
+	}
+
+	const char *data = buffer.Ptr() + buffer_offset;
+	idx_t lines = CountNewlines(data, remaining);
+	at_line_start = data[remaining - 1] == '\n';
+	buffer_offset = buffer_size;
+
+	if (Finished() && !at_line_start) {
+		// Final line without a trailing newline
+		lines++;
+		at_line_start = true;
+	}
+	return lines;
+}
+
+bool HttpdLogBufferedReader::SkipLine() {
+	while (true) {
+		auto *newline = static_cast<const char *>(
+		    memchr(buffer.Ptr() + buffer_offset, '\n', buffer_size - buffer_offset));
+		if (newline) {
+			buffer_offset = static_cast<idx_t>(newline - buffer.Ptr()) + 1;
+			return true;
+		}
+		buffer_offset = buffer_size;
+		if (eof_reached) {
+			return false;
+		}
+		RefillBuffer();
+	}
+}
+
+void HttpdLogBufferedReader::Seek(idx_t offset) {
+	D_ASSERT(seekable);
+	// Drop what was read so far; hints continue from the new position
+	AdviseConsumed(buffer_start + buffer_size);
+	advised_offset = offset;
+	file_handle->Seek(offset);
+	buffer_start = offset;
+	buffer_offset = 0;
+	buffer_size = 0;
+	eof_reached = false;
+	at_line_start = true;
+	RefillBuffer();
+}
+
+idx_t HttpdLogBufferedReader::GetFileSize() const {
+	return file_handle->GetFileSize();
+}
+
+bool HttpdLogBufferedReader::IsCompressedPath(const string &path) {
+	// Mirrors FileCompressionType::AUTO_DETECT
+	return StringUtil::EndsWith(path, ".gz") || StringUtil::EndsWith(path, ".zst");
+}
+
 bool HttpdLogBufferedReader::Finished() const {
 	return eof_reached && buffer_offset >= buffer_size;
 }
 
+HttpdLogReverseLineReader::HttpdLogReverseLineReader(unique_ptr<FileHandle> file_handle_p,
+                                                     optional_ptr<BufferManager> buffer_manager)
+    : file_handle(std::move(file_handle_p)), buffer(buffer_manager, HttpdLogBufferedReader::BUFFER_SIZE) {
+	chunk_start = file_handle->GetFileSize();
+	if (chunk_start == 0) {
+		finished = true;
+		return;
+	}
+	LoadPreviousChunk();
+	// The newline terminating the last line does not start another line
+	if (buffer.Ptr()[cursor - 1] == '\n') {
+		cursor--;
+	}
+}
+
+void HttpdLogReverseLineReader::LoadPreviousChunk() {
+	idx_t chunk_size = MinValue<idx_t>(chunk_start, HttpdLogBufferedReader::BUFFER_SIZE);
+	chunk_start -= chunk_size;
+	file_handle->Read(buffer.Ptr(), chunk_size, chunk_start);
+	cursor = chunk_size;
+}
+
+bool HttpdLogReverseLineReader::ReadLine(string &result) {
+	if (finished) {
+		return false;
+	}
+
+	while (true) {
+		// Search backwards for the newline that precedes the current line
+		idx_t line_start = cursor;
+		while (line_start > 0 && buffer.Ptr()[line_start - 1] != '\n') {
+			line_start--;
+		}
+		if (line_start > 0) {
+			result.assign(buffer.Ptr() + line_start, cursor - line_start);
+			result += carry;
+			carry.clear();
+			line_offset = chunk_start + line_start;
+			cursor = line_start - 1;
+			break;
+		}
+
+		if (chunk_start == 0) {
+			// First line of the file
+			result.assign(buffer.Ptr(), cursor);
+			result += carry;
+			carry.clear();
+			line_offset = 0;
+			cursor = 0;
+			finished = true;
+			break;
+		}
+
+		// The line continues into the previous chunk
+		carry.insert(0, buffer.Ptr(), cursor);
+		LoadPreviousChunk();
+	}
+
+	if (!result.empty() && result.back() == '\r') {
+		result.pop_back();
+	}
+	return true;
+}
+
 } // namespace duckdb
@@ -0,0 +1,292 @@
+#include "httpd_log_checkpoint.hpp"
+#include "httpd_log_buffered_reader.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/prepared_statement.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace duckdb {
+
+// Window read backwards from the end of a file when looking for its last newline
+static constexpr idx_t LINE_END_SEARCH_SIZE = 65536; // 64KB
+
+// Inode of a local file (0 when unknown): a rotated file gets a new inode even if it reuses the name
+static idx_t GetInode(const string &path) {
+#ifndef _WIN32
+	if (!FileSystem::IsRemoteFile(path)) {
+		struct stat st;
+		if (::stat(path.c_str(), &st) == 0) {
+			return static_cast<idx_t>(st.st_ino);
+		}
+	}
+#endif
+	return 0;
+}
+
+// First HEAD_HASH_SIZE bytes of the content (decompressed for compressed files)
+static string ReadHead(FileSystem &fs, const string &path) {
+	auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ | FileCompressionType::AUTO_DETECT);
+	string head(HttpdLogCheckpointStore::HEAD_HASH_SIZE, '\0');
+	idx_t read = 0;
+	while (read < head.size()) {
+		auto bytes = handle->Read(&head[read], head.size() - read);
+		if (bytes <= 0) {
+			break;
+		}
+		read += NumericCast<idx_t>(bytes);
+	}
+	head.resize(read);
+	return head;
+}
+
+// Offset just past the last newline in [start, file_size), or start if there is none
+static idx_t FindLastLineEnd(FileHandle &handle, idx_t start, idx_t file_size) {
+	auto buffer = make_unsafe_uniq_array_uninitialized<char>(LINE_END_SEARCH_SIZE);
+	idx_t window_end = file_size;
+	while (window_end > start) {
+		idx_t window_start = window_end - MinValue<idx_t>(window_end - start, LINE_END_SEARCH_SIZE);
+		handle.Read(buffer.get(), window_end - window_start, window_start);
+		for (idx_t i = window_end - window_start; i > 0; i--) {
+			if (buffer[i - 1] == '\n') {
+				return window_start + i;
+			}
+		}
+		window_end = window_start;
+	}
+	return start;
+}
+
+static string UpsertQuery(const string &table_name) {
+	return "INSERT OR REPLACE INTO " + table_name + " VALUES ($1, $2, $3, $4, $5, $6)";
+}
+
+static vector<Value> CheckpointValues(const string &path, const HttpdLogFileCheckpoint &checkpoint) {
+	return {Value(path),
+	        Value::UBIGINT(checkpoint.inode),
+	        Value::BIGINT(NumericCast<int64_t>(checkpoint.file_size)),
+	        Value::BIGINT(NumericCast<int64_t>(checkpoint.file_offset)),
+	        Value::BIGINT(NumericCast<int64_t>(checkpoint.line_number)),
+	        Value::UBIGINT(checkpoint.head_hash)};
+}
+
+hash_t HttpdLogCheckpointStore::HeadHash(const string &head, idx_t content_size) {
+	return Hash(head.data(), MinValue<idx_t>(head.size(), content_size));
+}
+
+string HttpdLogCheckpointStore::QuoteTableName(const string &table_name) {
+	auto qualified = QualifiedName::Parse(table_name);
+	string result;
+	if (!qualified.catalog.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(qualified.catalog) + ".";
+	}
+	if (!qualified.schema.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(qualified.schema) + ".";
+	}
+	return result + KeywordHelper::WriteOptionallyQuoted(qualified.name);
+}
+
+void HttpdLogCheckpointStore::CreateTable(Connection &connection, const string &table_name) {
+	auto created = connection.Query("CREATE TABLE IF NOT EXISTS " + table_name +
+	                                " (log_file VARCHAR PRIMARY KEY, inode UBIGINT, file_size BIGINT, "
+	                                "file_offset BIGINT, line_number BIGINT, head_hash UBIGINT)");
+	if (created->HasError()) {
+		created->ThrowError("checkpoint_table: ");
+	}
+}
+
+void HttpdLogCheckpointStore::WriteCheckpoints(Connection &connection, const string &table_name,
+                                               const vector<pair<string, HttpdLogFileCheckpoint>> &checkpoints) {
+	if (checkpoints.empty()) {
+		return;
+	}
+	auto upsert = connection.Prepare(UpsertQuery(table_name));
+	if (upsert->HasError()) {
+		throw BinderException("checkpoint_table: %s has an unexpected layout: %s", table_name, upsert->GetError());
+	}
+	for (auto &entry : checkpoints) {
+		auto values = CheckpointValues(entry.first, entry.second);
+		auto result = upsert->Execute(values, false);
+		if (result->HasError()) {
+			result->ThrowError("checkpoint_table: ");
+		}
+	}
+}
+
+HttpdLogCheckpointStore::HttpdLogCheckpointStore(ClientContext &context, const string &table_name_p)
+    : connection(make_uniq<Connection>(*context.db)),
+      table_name(QuoteTableName(table_name_p)) {
+	// The table is created when the first checkpoints are committed: until then there are none
+	auto result =
+	    connection->Query("SELECT log_file, inode, file_size, file_offset, line_number, head_hash FROM " + table_name);
+	bool table_exists = !result->HasError();
+	if (!table_exists && result->GetErrorType() != ExceptionType::CATALOG) {
+		result->ThrowError("checkpoint_table: ");
+	}
+	for (idx_t row = 0; table_exists && row < result->RowCount(); row++) {
+		auto log_file = result->GetValue(0, row);
+		if (log_file.IsNull()) {
+			continue;
+		}
+		HttpdLogFileCheckpoint checkpoint;
+		auto get = [&](idx_t col) -> idx_t {
+			auto value = result->GetValue(col, row);
+			return value.IsNull() ? 0 : value.GetValue<idx_t>();
+		};
+		checkpoint.inode = get(1);
+		checkpoint.file_size = get(2);
+		checkpoint.file_offset = get(3);
+		checkpoint.line_number = get(4);
+		checkpoint.head_hash = get(5);
+		checkpoints[StringValue::Get(log_file)] = checkpoint;
+	}
+
+	pending = context.registered_state->Get<HttpdLogPendingCheckpoints>(HttpdLogPendingCheckpoints::KEY);
+	if (pending) {
+		return;
+	}
+	// Fail now rather than when the transaction commits
+	if (table_exists) {
+		auto upsert = connection->Prepare(UpsertQuery(table_name));
+		if (upsert->HasError()) {
+			throw BinderException("checkpoint_table: %s has an unexpected layout: %s", table_name_p,
+			                      upsert->GetError());
+		}
+	}
+	transaction_checkpoints =
+	    context.registered_state->GetOrCreate<HttpdLogTransactionCheckpoints>(HttpdLogTransactionCheckpoints::KEY);
+}
+
+HttpdLogCheckpointStore::~HttpdLogCheckpointStore() {
+}
+
+optional_ptr<const HttpdLogFileCheckpoint>
+HttpdLogCheckpointStore::FindCheckpoint(const string &path, const HttpdLogResumePoint &current, bool compressed) const {
+	auto &file = current.file;
+	// Same content start; a plain file has at least as many bytes as were read from it
+	auto same_content = [&](const HttpdLogFileCheckpoint &checkpoint) {
+		if (current.head.size() < MinValue<idx_t>(checkpoint.file_offset, HEAD_HASH_SIZE)) {
+			return false;
+		}
+		if (!compressed && file.file_size < checkpoint.file_offset) {
+			return false;
+		}
+		return HeadHash(current.head, checkpoint.file_offset) == checkpoint.head_hash;
+	};
+
+	optional_ptr<const HttpdLogFileCheckpoint> result;
+	if (pending && pending->restart_files.count(path)) {
+		return result;
+	}
+
+	// The same file: same inode, not truncated
+	auto entry = checkpoints.find(path);
+	if (entry != checkpoints.end()) {
+		auto &previous = entry->second;
+		if (previous.inode == file.inode && file.file_size >= previous.file_size && same_content(previous)) {
+			return &previous;
+		}
+	}
+
+	// Rotation renamed (and maybe compressed) a file that was read under another name:
+	// continue from the checkpoint that got furthest into the same content
+	if (pending && !pending->follow_renames) {
+		return result;
+	}
+	for (auto &other : checkpoints) {
+		if (other.first == path || other.second.file_offset == 0) {
+			continue;
+		}
+		if (same_content(other.second) && (!result || other.second.file_offset > result->file_offset)) {
+			result = &other.second;
+		}
+	}
+	return result;
+}
+
+HttpdLogResumePoint HttpdLogCheckpointStore::Plan(FileSystem &fs, const string &path) const {
+	HttpdLogResumePoint result;
+	if (pending) {
+		lock_guard<mutex> guard(pending->lock);
+		pending->files_planned++;
+	}
+	auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+	if (!handle->CanSeek()) {
+		// Pipes and the like: read everything, every time
+		return result;
+	}
+	// Compressed files cannot seek: they resume by skipping lines, and are skipped altogether while unchanged
+	bool compressed = HttpdLogBufferedReader::IsCompressedPath(path);
+
+	auto &file = result.file;
+	file.inode = GetInode(path);
+	file.file_size = handle->GetFileSize();
+	result.head = ReadHead(fs, path);
+
+	auto previous = FindCheckpoint(path, result, compressed);
+	if (previous) {
+		auto entry = checkpoints.find(path);
+		if (compressed && entry != checkpoints.end() && previous.get() == &entry->second &&
+		    file.file_size == previous->file_size) {
+			result.unchanged = true;
+			return result;
+		}
+		result.start_offset = previous->file_offset;
+		result.start_line_number = previous->line_number;
+	}
+
+	if (!compressed) {
+		result.end_offset = FindLastLineEnd(*handle, result.start_offset, file.file_size);
+		result.read_partial_line = pending && pending->read_partial_line;
+	}
+	return result;
+}
+
+void HttpdLogCheckpointStore::Commit(const string &path, const HttpdLogFileCheckpoint &checkpoint) {
+	if (pending) {
+		lock_guard<mutex> guard(pending->lock);
+		pending->checkpoints.emplace_back(path, checkpoint);
+		return;
+	}
+	lock_guard<mutex> guard(transaction_checkpoints->lock);
+	transaction_checkpoints->checkpoints[table_name].emplace_back(path, checkpoint);
+}
+
+void HttpdLogTransactionCheckpoints::TransactionCommit(MetaTransaction &transaction, ClientContext &context) {
+	map<string, vector<pair<string, HttpdLogFileCheckpoint>>> committed;
+	{
+		lock_guard<mutex> guard(lock);
+		std::swap(committed, checkpoints);
+	}
+	if (committed.empty()) {
+		return;
+	}
+	// The query's own transaction cannot be written to while it commits: the checkpoints of all tables are
+	// written together just before it
+	Connection connection(*context.db);
+	connection.BeginTransaction();
+	try {
+		for (auto &entry : committed) {
+			HttpdLogCheckpointStore::CreateTable(connection, entry.first);
+			HttpdLogCheckpointStore::WriteCheckpoints(connection, entry.first, entry.second);
+		}
+		connection.Commit();
+	} catch (...) {
+		if (connection.HasActiveTransaction()) {
+			connection.Rollback();
+		}
+		throw;
+	}
+}
+
+void HttpdLogTransactionCheckpoints::TransactionRollback(MetaTransaction &transaction, ClientContext &context) {
+	// The rows were not kept: the next scan returns them again
+	lock_guard<mutex> guard(lock);
+	checkpoints.clear();
+}
+
+} // namespace duckdb
@@ -3,6 +3,13 @@
 #include "httpd_log_extension.hpp"
 #include "httpd_log_table_function.hpp"
 #include "httpd_conf_reader.hpp"
+#include "httpd_log_time_range.hpp"
+#include "httpd_log_fetch.hpp"
+#include "httpd_log_sync.hpp"
+#include "httpd_log_summary.hpp"
+#include "httpd_log_sketch.hpp"
+#include "httpd_log_sessions.hpp"
+#include "httpd_log_inflate_cache.hpp"
 #include "duckdb.hpp"
 #include "duckdb/common/exception.hpp"
 
@@ -14,6 +21,27 @@ static void LoadInternal(ExtensionLoader &loader) {
 
 	// Register the read_httpd_conf table function
 	HttpdConfReader::RegisterFunction(loader);
+
+	// Register the httpd_log_time_range table function
+	HttpdLogTimeRange::RegisterFunction(loader);
+
+	// Register the httpd_log_fetch table function
+	HttpdLogFetch::RegisterFunction(loader);
+
+	// Register the httpd_log_sync table function
+	HttpdLogSync::RegisterFunction(loader);
+
+	// Register the httpd_log_summary table function
+	HttpdLogSummary::RegisterFunction(loader);
+
+	// Register the sketch aggregates (httpd_log_hll, httpd_log_ddsketch) and their functions
+	HttpdLogSketch::RegisterFunctions(loader);
+
+	// Register the httpd_log_sessions table function
+	HttpdLogSessions::RegisterFunction(loader);
+
+	// Register the httpd_log_inflate_cache_size setting
+	HttpdLogInflateCache::RegisterSetting(loader);
 }
 
 void HttpdLogExtension::Load(ExtensionLoader &loader) {
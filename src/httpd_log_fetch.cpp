@@ -0,0 +1,166 @@
+#include "httpd_log_fetch.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/multi_file/multi_file_list.hpp"
+#include "duckdb/main/client_context.hpp"
+#include <algorithm>
+
+namespace duckdb {
+
+// Lines are fetched one at a time from arbitrary offsets: a small buffer avoids reading far past each line
+static constexpr idx_t FETCH_BUFFER_SIZE = 65536; // 64KB
+
+void HttpdLogFetch::ReadLineAt(HttpdLogBufferedReader &reader, const string &path, idx_t offset, string &line) {
+	if (reader.GetOffset() != offset) {
+		if (reader.CanSeek()) {
+			if (offset >= reader.GetFileSize()) {
+				throw InvalidInputException("httpd_log_fetch: offset %llu is past the end of '%s'", offset, path);
+			}
+			// The byte before a line is the newline of the previous line
+			reader.Seek(offset > 0 ? offset - 1 : 0);
+			if (offset > 0) {
+				reader.SkipLine();
+			}
+		} else {
+			// Compressed/non-seekable: offsets are in the decompressed stream, skip forward to them
+			while (reader.GetOffset() < offset && reader.SkipLine()) {
+			}
+		}
+		if (reader.GetOffset() != offset) {
+			throw InvalidInputException("httpd_log_fetch: offset %llu is not the start of a line in '%s'", offset,
+			                            path);
+		}
+	}
+	if (!reader.ReadLine(line)) {
+		throw InvalidInputException("httpd_log_fetch: offset %llu is past the end of '%s'", offset, path);
+	}
+}
+
+unique_ptr<FunctionData> HttpdLogFetch::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("httpd_log_fetch: file cannot be NULL");
+	}
+	auto bind_data = make_uniq<BindData>();
+	bind_data->path = input.inputs[0].GetValue<string>();
+
+	// Offsets as produced by the file_offset column of read_httpd_log
+	if (!input.inputs[1].IsNull()) {
+		for (auto &offset_value : ListValue::GetChildren(input.inputs[1])) {
+			if (offset_value.IsNull()) {
+				continue;
+			}
+			auto offset = offset_value.GetValue<int64_t>();
+			if (offset < 0) {
+				throw BinderException("httpd_log_fetch: offsets must be >= 0, got %lld", offset);
+			}
+			bind_data->offsets.push_back(NumericCast<idx_t>(offset));
+		}
+	}
+	// Read in file order: sequential for compressed files, forward seeks otherwise
+	std::sort(bind_data->offsets.begin(), bind_data->offsets.end());
+	bind_data->offsets.erase(std::unique(bind_data->offsets.begin(), bind_data->offsets.end()),
+	                         bind_data->offsets.end());
+
+	// Same format options as read_httpd_log
+	auto &httpd_data = bind_data->httpd_data;
+	for (auto &param : input.named_parameters) {
+		if (param.second.IsNull()) {
+			throw BinderException("Cannot use NULL as argument to key %s", param.first);
+		}
+		auto loption = StringUtil::Lower(param.first);
+		if (loption == "format_type") {
+			httpd_data.format_type = StringValue::Get(param.second);
+		} else if (loption == "format_str") {
+			httpd_data.format_str = StringValue::Get(param.second);
+		} else if (loption == "conf") {
+			httpd_data.conf = StringValue::Get(param.second);
+		}
+	}
+
+	SimpleMultiFileList file_list(vector<OpenFileInfo> {OpenFileInfo(bind_data->path)});
+	HttpdLogMultiFileInfo::BindFormat(context, httpd_data, file_list);
+	if (!httpd_data.parsed_format.compiled_regex) {
+		throw BinderException("httpd_log_fetch: could not determine the log format, specify format_type, "
+		                      "format_str or conf");
+	}
+	httpd_data.raw_mode = true;
+
+	names.emplace_back("file_offset");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	// The read_httpd_log columns (raw=true), except line_number: lines are reached without counting them
+	vector<string> schema_names;
+	vector<LogicalType> schema_types;
+	HttpdLogFormatParser::GenerateSchema(httpd_data.parsed_format, schema_names, schema_types, true, false);
+	// The raw columns come last in the schema: a format column may have the same name
+	optional_idx line_number_col;
+	for (idx_t col = schema_names.size(); col > 0 && !line_number_col.IsValid(); col--) {
+		if (schema_names[col - 1] == "line_number") {
+			line_number_col = col - 1;
+		}
+	}
+	for (idx_t i = 0; i < schema_names.size(); i++) {
+		if (line_number_col.IsValid() && i == line_number_col.GetIndex()) {
+			continue;
+		}
+		bind_data->schema_column_ids.push_back(i);
+		names.push_back(schema_names[i]);
+		return_types.push_back(schema_types[i]);
+	}
+
+	return std::move(bind_data);
+}
+
+unique_ptr<GlobalTableFunctionState> HttpdLogFetch::Init(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<BindData>();
+	auto result = make_uniq<GlobalState>();
+	if (bind_data.offsets.empty()) {
+		return std::move(result);
+	}
+	auto &fs = FileSystem::GetFileSystem(context);
+	auto &buffer_manager = BufferManager::GetBufferManager(context);
+	idx_t buffer_size = HttpdLogBufferedReader::IsCompressedPath(bind_data.path) ? HttpdLogBufferedReader::BUFFER_SIZE
+	                                                                             : FETCH_BUFFER_SIZE;
+	result->line_reader = make_uniq<HttpdLogBufferedReader>(fs, bind_data.path,
+	                                                        HttpdLogReadBuffer(&buffer_manager, buffer_size));
+	result->column_writer = make_uniq<HttpdLogFileReader>(context, OpenFileInfo(bind_data.path), bind_data.httpd_data);
+	return std::move(result);
+}
+
+void HttpdLogFetch::Function(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<BindData>();
+	auto &state = data.global_state->Cast<GlobalState>();
+	const auto &parsed_format = bind_data.httpd_data.parsed_format;
+
+	idx_t output_idx = 0;
+	string line;
+	while (output_idx < STANDARD_VECTOR_SIZE && state.next_offset_idx < bind_data.offsets.size()) {
+		idx_t offset = bind_data.offsets[state.next_offset_idx++];
+		ReadLineAt(*state.line_reader, bind_data.path, offset, line);
+
+		// Only the requested lines are parsed
+		auto parsed_values = HttpdLogFormatParser::ParseLogLine(line, parsed_format);
+		bool parse_error = parsed_values.empty();
+
+		FlatVector::GetData<int64_t>(output.data[0])[output_idx] = static_cast<int64_t>(offset);
+		for (idx_t i = 0; i < bind_data.schema_column_ids.size(); i++) {
+			state.column_writer->WriteColumnValue(output.data[i + 1], output_idx, bind_data.schema_column_ids[i],
+			                                      parsed_values, line, parse_error, offset);
+		}
+		output_idx++;
+	}
+
+	output.SetCardinality(output_idx);
+}
+
+void HttpdLogFetch::RegisterFunction(ExtensionLoader &loader) {
+	TableFunction func("httpd_log_fetch", {LogicalType::VARCHAR, LogicalType::LIST(LogicalType::BIGINT)}, Function,
+	                   Bind, Init);
+	func.named_parameters["format_type"] = LogicalType::VARCHAR;
+	func.named_parameters["format_str"] = LogicalType::VARCHAR;
+	func.named_parameters["conf"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(func);
+}
+
+} // namespace duckdb
@@ -5,12 +5,20 @@
 #include "duckdb/common/types/interval.hpp"
 #include "duckdb/common/types/date.hpp"
 #include "duckdb/common/types/time.hpp"
+#include "duckdb/common/random_engine.hpp"
+#include "duckdb/common/types/hash.hpp"
 #include "duckdb/main/client_context.hpp"
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <unordered_set>
 
 namespace duckdb {
 
+// Unit of block sampling; small enough that a 1% sample still spreads over a file,
+// large enough that each sampled block is a single sequential read
+static constexpr idx_t SAMPLE_BLOCK_SIZE = 262144; // 256KB
+
 // Parse a strftime-formatted timestamp string into timestamp_t
 static bool ParseStrftimeTimestamp(const string &value, const string &format, timestamp_t &result,
                                    int &parsed_tz_offset_seconds) {
@@ -307,27 +315,421 @@ static bool CombineTimestampGroup(const ParsedFormat &parsed_format, const Times
 	return false;
 }
 
+bool HttpdLogFileReader::ExtractTimestamp(const ParsedFormat &parsed_format, const vector<string> &parsed_values,
+                                          timestamp_t &result) {
+	// Walk fields the same way WriteColumnValue does to locate the values of the "timestamp" column
+	idx_t value_idx = 0;
+	std::unordered_set<int> processed_ts_groups;
+
+	for (const auto &field : parsed_format.fields) {
+		if (field.should_skip) {
+			if (field.directive != "%t") {
+				value_idx++;
+			}
+			continue;
+		}
+
+		if (field.directive != "%t") {
+			value_idx++;
+			continue;
+		}
+
+		int group_id = field.timestamp_group_id;
+		if (group_id >= 0 && processed_ts_groups.count(group_id) == 0) {
+			processed_ts_groups.insert(group_id);
+			const auto &group = parsed_format.timestamp_groups[group_id];
+			if (field.column_name == "timestamp") {
+				string raw_combined;
+				return CombineTimestampGroup(parsed_format, group, parsed_values, value_idx, result, raw_combined);
+			}
+			value_idx += group.field_indices.size();
+		} else if (group_id < 0) {
+			if (field.column_name == "timestamp") {
+				return HttpdLogFormatParser::ParseTimestamp(parsed_values[value_idx], result);
+			}
+			value_idx++;
+		}
+	}
+	return false;
+}
+
+bool HttpdLogFileReader::ExtractPath(const ParsedFormat &parsed_format, const vector<string> &parsed_values,
+                                     string &result) {
+	// Walk fields the same way WriteColumnValue does to locate the value of the "path" column
+	idx_t value_idx = 0;
+	std::unordered_set<int> processed_ts_groups;
+
+	for (const auto &field : parsed_format.fields) {
+		if (field.directive == "%t") {
+			if (field.should_skip) {
+				continue;
+			}
+			int group_id = field.timestamp_group_id;
+			if (group_id < 0) {
+				value_idx++;
+			} else if (processed_ts_groups.insert(group_id).second) {
+				value_idx += parsed_format.timestamp_groups[group_id].field_indices.size();
+			}
+			continue;
+		}
+		if (!field.should_skip) {
+			bool request_line = field.directive == "%r" || field.directive == "%>r" || field.directive == "%<r";
+			if (request_line && !field.skip_path) {
+				string method, query_string, protocol;
+				return HttpdLogFormatParser::ParseRequest(parsed_values[value_idx], method, result, query_string,
+				                                          protocol);
+			}
+			if (!request_line && field.column_name == "path") {
+				result = parsed_values[value_idx];
+				return true;
+			}
+		}
+		value_idx++;
+	}
+	return false;
+}
+
 HttpdLogFileReader::HttpdLogFileReader(ClientContext &context, OpenFileInfo file_p, const HttpdLogBindData &bind_data_p)
     : BaseFileReader(std::move(file_p)), bind_data(bind_data_p) {
-	// Initialize the buffered reader
-	auto &fs = FileSystem::GetFileSystem(context);
-	buffered_reader = make_uniq<HttpdLogBufferedReader>(fs, file.path);
-
 	// Populate the columns vector (required for MultiFileReader schema matching)
+	// The schema is the same for every file: reuse the one generated at bind time
+	if (!bind_data.schema_names.empty()) {
+		for (idx_t i = 0; i < bind_data.schema_names.size(); i++) {
+			columns.emplace_back(bind_data.schema_names[i], bind_data.schema_types[i]);
+		}
+		schema_column_count = columns.size();
+		return;
+	}
 	// Use GenerateSchema to get schema, then convert to MultiFileColumnDefinition
 	vector<string> names;
 	vector<LogicalType> types;
-	HttpdLogFormatParser::GenerateSchema(bind_data.parsed_format, names, types, bind_data.raw_mode);
+	HttpdLogFormatParser::GenerateSchema(bind_data.parsed_format, names, types, bind_data.raw_mode,
+	                                     bind_data.sampling);
 
 	for (idx_t i = 0; i < names.size(); i++) {
 		columns.emplace_back(names[i], types[i]);
 	}
+	schema_column_count = columns.size();
+}
+
+void HttpdLogFileReader::AddVirtualColumn(column_t virtual_column_id) {
+	string name;
+	if (virtual_column_id == COLUMN_IDENTIFIER_FILE_OFFSET) {
+		name = "file_offset";
+	} else if (virtual_column_id == COLUMN_IDENTIFIER_LINE_NUMBER) {
+		name = "line_number";
+	} else if (virtual_column_id == COLUMN_IDENTIFIER_ROUTE) {
+		name = "route";
+	} else {
+		throw InternalException("Unsupported virtual column id %d for httpd_log reader", virtual_column_id);
+	}
+	// The column mapper refers to the virtual column by its position in columns
+	if (columns.size() == schema_column_count + virtual_column_ids.size()) {
+		columns.emplace_back(name, virtual_column_id == COLUMN_IDENTIFIER_ROUTE ? LogicalType::VARCHAR
+		                                                                       : LogicalType::BIGINT);
+	}
+	virtual_column_ids.push_back(virtual_column_id);
+}
+
+void HttpdLogFileReader::OpenReader(ClientContext &context, HttpdLogGlobalState &gstate, HttpdLogLocalState &lstate) {
+	auto &fs = FileSystem::GetFileSystem(context);
+	// Read buffers are allocated through the buffer manager so they count toward memory_limit
+	auto &buffer_manager = BufferManager::GetBufferManager(context);
+
+	// reverse=true: read seekable files from EOF (compressed/non-seekable files are read forward)
+	if (bind_data.reverse && !column_ids.empty() && !HttpdLogBufferedReader::IsCompressedPath(file.path)) {
+		auto handle = fs.OpenFile(file.path, FileFlags::FILE_FLAGS_READ);
+		if (handle->CanSeek()) {
+			// line_number counts from the start of the file: count the lines first if it is projected
+			bool line_number_projected = gstate.line_number_projected;
+			if (bind_data.raw_mode) {
+				// Raw mode's line_number column: the raw columns come last in the schema
+				optional_idx line_number_col;
+				for (idx_t col = schema_column_count; col > 0; col--) {
+					if (columns[col - 1].name == "line_number") {
+						line_number_col = col - 1;
+						break;
+					}
+				}
+				for (idx_t i = 0; i < column_ids.size() && line_number_col.IsValid(); i++) {
+					if (column_ids[MultiFileLocalIndex(i)].GetId() == line_number_col.GetIndex()) {
+						line_number_projected = true;
+						break;
+					}
+				}
+			}
+			if (line_number_projected) {
+				HttpdLogBufferedReader counter(
+				    fs, file.path, HttpdLogReadBuffer(&buffer_manager, HttpdLogBufferedReader::BUFFER_SIZE));
+				while (!counter.Finished()) {
+					current_line_number += counter.CountLines();
+				}
+				current_line_number++;
+			}
+			reverse_reader = make_uniq<HttpdLogReverseLineReader>(std::move(handle), &buffer_manager);
+			return;
+		}
+	}
+
+	if (bind_data.sampling && bind_data.sample_rate < 1.0) {
+		// Sampled blocks are read one at a time: no point in reading 2MB per block
+		// Sampling seeks to arbitrary offsets: direct I/O is not possible, dropping consumed data is
+		auto cache_mode = bind_data.cache_mode == HttpdLogCacheMode::DIRECT ? HttpdLogCacheMode::DROP_BEHIND
+		                                                                    : bind_data.cache_mode;
+		buffered_reader = make_uniq<HttpdLogBufferedReader>(
+		    fs, file.path, HttpdLogReadBuffer(&buffer_manager, SAMPLE_BLOCK_SIZE), cache_mode);
+		InitializeSampling();
+		return;
+	}
+	if (gstate.checkpoints) {
+		// checkpoint_table: continue after the last complete line of the previous scan of this file
+		checkpoint_store = gstate.checkpoints.get();
+		resume_point = checkpoint_store->Plan(fs, file.path);
+		if (resume_point.unchanged) {
+			// Nothing new: Scan finishes the file without opening it
+			return;
+		}
+		current_line_number = resume_point.start_line_number;
+	}
+	if (gstate.open_ahead) {
+		buffered_reader = gstate.open_ahead->Take(file.path);
+		if (buffered_reader) {
+			return;
+		}
+	}
+	HttpdLogReadBuffer buffer;
+	if (lstate.spare_buffer.IsSet()) {
+		buffer = std::move(lstate.spare_buffer);
+	} else {
+		// Aligned so that cache_mode='direct' can read into it
+		buffer = HttpdLogReadBuffer(&buffer_manager, HttpdLogBufferedReader::BUFFER_SIZE,
+		                            HttpdLogBufferedReader::DIRECT_IO_ALIGNMENT);
+	}
+	// Resuming at an arbitrary offset: no direct I/O
+	auto cache_mode = bind_data.cache_mode;
+	if (resume_point.start_offset > 0 && cache_mode == HttpdLogCacheMode::DIRECT) {
+		cache_mode = HttpdLogCacheMode::DROP_BEHIND;
+	}
+	bool compressed = HttpdLogBufferedReader::IsCompressedPath(file.path);
+	buffered_reader =
+	    make_uniq<HttpdLogBufferedReader>(fs, file.path, std::move(buffer), cache_mode,
+	                                      compressed ? 0 : resume_point.start_offset, gstate.inflate_cache);
+	if (compressed) {
+		// A rotated file compressed after it was read under its previous name: skip what was read then
+		while (buffered_reader->GetOffset() < resume_point.start_offset && buffered_reader->SkipLine()) {
+		}
+	}
+}
+
+void HttpdLogFileReader::FinishScan(HttpdLogLocalState &lstate) {
+	finished.store(true, std::memory_order_release);
+	if (checkpoint_store && buffered_reader) {
+		auto checkpoint = resume_point.file;
+		checkpoint.file_offset = buffered_reader->GetOffset();
+		checkpoint.line_number = current_line_number;
+		if (checkpoint.file_offset > resume_point.end_offset) {
+			// The partial last line was returned (read_partial_line): the next scan reads it again once complete
+			checkpoint.file_offset = resume_point.end_offset;
+			checkpoint.line_number--;
+		}
+		checkpoint.head_hash = HttpdLogCheckpointStore::HeadHash(resume_point.head, checkpoint.file_offset);
+		checkpoint_store->Commit(file.path, checkpoint);
+	}
+	// Recycle only full-size buffers (sampling uses smaller ones)
+	if (buffered_reader && !lstate.spare_buffer.IsSet() &&
+	    buffered_reader->GetBufferCapacity() == HttpdLogBufferedReader::BUFFER_SIZE) {
+		lstate.spare_buffer = buffered_reader->ReleaseBuffer();
+	}
+	// Close the file now rather than when the reader is destroyed: a glob may hold thousands of finished readers
+	buffered_reader.reset();
+	reverse_reader.reset();
+}
+
+void HttpdLogFileReader::InitializeSampling() {
+	block_sampling = true;
+	if (!buffered_reader->CanSeek()) {
+		// The stream has to be decompressed anyway: keep every k-th block, skip parsing the rest
+		// sample_fraction is set per kept block (see ReadSampledStreamBlock)
+		sample_stride = MaxValue<idx_t>(1, static_cast<idx_t>(std::llround(1.0 / bind_data.sample_rate)));
+		return;
+	}
+
+	// Seekable file: choose each block independently with probability sample_rate
+	// A fixed sample_seed gives each file its own but reproducible selection
+	int64_t seed = bind_data.sample_seed;
+	if (seed >= 0) {
+		seed = static_cast<int64_t>((static_cast<uint64_t>(seed) ^ Hash(file.path.c_str())) & 0x7FFFFFFFFFFFFFFFULL);
+	}
+	RandomEngine random(seed);
+
+	idx_t file_size = buffered_reader->GetFileSize();
+	idx_t block_count = (file_size + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE;
+	idx_t sampled_bytes = 0;
+	for (idx_t block = 0; block < block_count; block++) {
+		if (random.NextRandom() < bind_data.sample_rate) {
+			sample_blocks.push_back(block);
+			sampled_bytes += MinValue<idx_t>(SAMPLE_BLOCK_SIZE, file_size - block * SAMPLE_BLOCK_SIZE);
+		}
+	}
+	sample_fraction = file_size == 0 ? bind_data.sample_rate
+	                                 : static_cast<double>(sampled_bytes) / static_cast<double>(file_size);
+	line_numbers_known = sample_blocks.size() == block_count;
+}
+
+bool HttpdLogFileReader::ReadNextSampledLine(string &line) {
+	if (buffered_reader->CanSeek()) {
+		while (true) {
+			// A line belongs to the block its first byte is in
+			if (buffered_reader->GetOffset() < sample_block_end) {
+				current_line_offset = buffered_reader->GetOffset();
+				if (!buffered_reader->ReadLine(line)) {
+					return false;
+				}
+				current_line_number++;
+				return true;
+			}
+			if (next_sample_block >= sample_blocks.size()) {
+				return false;
+			}
+			idx_t block_start = sample_blocks[next_sample_block++] * SAMPLE_BLOCK_SIZE;
+			sample_block_end = block_start + SAMPLE_BLOCK_SIZE;
+			if (buffered_reader->GetOffset() >= block_start) {
+				// Adjacent block (or the previous line ran into it): keep reading
+				continue;
+			}
+			if (block_start == 0) {
+				buffered_reader->Seek(0);
+			} else {
+				// Resync to the first line starting at or after block_start
+				buffered_reader->Seek(block_start - 1);
+				if (!buffered_reader->SkipLine()) {
+					return false;
+				}
+			}
+		}
+	}
+
+	// Stream: return the lines starting in every sample_stride-th block
+	while (next_stream_line >= stream_lines.size()) {
+		if (stream_finished && !stream_carry_offset.IsValid()) {
+			return false;
+		}
+		ReadSampledStreamBlock();
+	}
+	line = std::move(stream_lines[next_stream_line]);
+	current_line_offset = stream_line_offsets[next_stream_line];
+	current_line_number = stream_first_line_number + next_stream_line;
+	next_stream_line++;
+	return true;
+}
+
+void HttpdLogFileReader::ReadSampledStreamBlock() {
+	// A kept block stands for itself and the skipped blocks after it: sample_stride blocks, fewer at the end of
+	// the stream. Its lines are returned once the stream shows how many, which gives their sample_fraction
+	stream_lines.clear();
+	stream_line_offsets.clear();
+	next_stream_line = 0;
+	optional_idx kept_block;
+	if (stream_carry_offset.IsValid()) {
+		kept_block = stream_carry_offset.GetIndex() / SAMPLE_BLOCK_SIZE;
+		stream_first_line_number = stream_line_count;
+		stream_lines.push_back(std::move(stream_carry_line));
+		stream_line_offsets.push_back(stream_carry_offset.GetIndex());
+		stream_carry_offset = optional_idx();
+	}
+	string line;
+	while (!stream_finished) {
+		idx_t line_start = buffered_reader->GetOffset();
+		if (!buffered_reader->ReadLine(line)) {
+			stream_finished = true;
+			break;
+		}
+		stream_line_count++;
+		idx_t block = line_start / SAMPLE_BLOCK_SIZE;
+		bool kept = block % sample_stride == 0;
+		if (!kept_block.IsValid()) {
+			if (kept) {
+				kept_block = block;
+				stream_first_line_number = stream_line_count;
+				stream_lines.push_back(std::move(line));
+				stream_line_offsets.push_back(line_start);
+			}
+			continue;
+		}
+		if (block == kept_block.GetIndex()) {
+			stream_lines.push_back(std::move(line));
+			stream_line_offsets.push_back(line_start);
+			continue;
+		}
+		if (block < kept_block.GetIndex() + sample_stride) {
+			continue;
+		}
+		// Past the skipped blocks: the kept block stands for sample_stride blocks
+		if (kept) {
+			stream_carry_line = std::move(line);
+			stream_carry_offset = line_start;
+		}
+		sample_fraction = 1.0 / static_cast<double>(sample_stride);
+		return;
+	}
+	if (kept_block.IsValid()) {
+		// End of the stream: the kept block stands for the blocks left
+		idx_t block_count = (buffered_reader->GetOffset() + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE;
+		sample_fraction =
+		    1.0 / static_cast<double>(MinValue<idx_t>(sample_stride, block_count - kept_block.GetIndex()));
+	}
+}
+
+bool HttpdLogFileReader::ReadNextLine(string &line) {
+	if (reverse_reader) {
+		if (!reverse_reader->ReadLine(line)) {
+			return false;
+		}
+		current_line_number--;
+		current_line_offset = reverse_reader->GetLineOffset();
+		return true;
+	}
+	if (block_sampling) {
+		return ReadNextSampledLine(line);
+	}
+	current_line_offset = buffered_reader->GetOffset();
+	// checkpoint_table: a partial last line is left for the next scan; read_partial_line returns it, but not the
+	// lines appended after the file was opened
+	idx_t end_offset = resume_point.read_partial_line ? resume_point.file.file_size : resume_point.end_offset;
+	if (current_line_offset >= end_offset || !buffered_reader->ReadLine(line)) {
+		return false;
+	}
+	current_line_number++;
+	return true;
+}
+
+bool HttpdLogFileReader::CanSplit(const HttpdLogBindData &bind_data, const string &path) {
+	return !bind_data.reverse && !bind_data.sampling && !bind_data.raw_mode && bind_data.checkpoint_table.empty() &&
+	       !HttpdLogBufferedReader::IsCompressedPath(path) && !FileSystem::IsRemoteFile(path);
+}
+
+idx_t HttpdLogFileReader::RangeCount(idx_t file_size) {
+	return MaxValue<idx_t>(1, (file_size + SPLIT_SIZE - 1) / SPLIT_SIZE);
+}
+
+void HttpdLogFileReader::PlanSplit(ClientContext &context, const HttpdLogGlobalState &gstate) {
+	if (gstate.line_number_projected || !CanSplit(bind_data, file.path)) {
+		return;
+	}
+	auto &fs = FileSystem::GetFileSystem(context);
+	auto handle = fs.OpenFile(file.path, FileFlags::FILE_FLAGS_READ);
+	if (!handle->CanSeek()) {
+		return;
+	}
+	split_file_size = handle->GetFileSize();
+	range_count = RangeCount(split_file_size);
+	split_scan = range_count > 1;
 }
 
 bool HttpdLogFileReader::TryInitializeScan(ClientContext &context, GlobalTableFunctionState &gstate,
-                                           LocalTableFunctionState &lstate) {
-	// httpd_log has no intra-file parallelism (unlike Parquet row groups)
-	// TryInitializeScan should return true only once per file
+                                           LocalTableFunctionState &lstate_p) {
+	// Called under the multi-file global lock
+	// A file is scanned as a whole (TryInitializeScan returns true once), or as ranges when it is split
 
 	// Thread-safe check: if already finished, return false
 	if (finished.load(std::memory_order_acquire)) {
@@ -336,17 +738,110 @@ bool HttpdLogFileReader::TryInitializeScan(ClientContext &context, GlobalTableFu
 
 	// Thread-safe atomic check-and-set: only one thread can succeed
 	bool expected = false;
-	if (!scan_initialized.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+	if (scan_initialized.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+		auto &httpd_gstate = gstate.Cast<HttpdLogGlobalState>();
+		if (httpd_gstate.merge) {
+			// assume_sorted: the first reader hosts the merge of all files, the others have nothing left to emit
+			if (httpd_gstate.merge_claimed) {
+				finished.store(true, std::memory_order_release);
+				return false;
+			}
+			httpd_gstate.merge_claimed = true;
+			merge_host = true;
+			return true;
+		}
+		// First scan of this file: decide whether it is split into ranges
+		PlanSplit(context, httpd_gstate);
+		if (!split_scan) {
+			return true;
+		}
+	} else if (!split_scan) {
 		// Another thread already initialized this reader
 		return false;
 	}
 
+	// Hand out ranges in file order: batch indexes then follow file order
+	idx_t range_idx = next_range.fetch_add(1);
+	if (range_idx >= range_count) {
+		finished.store(true, std::memory_order_release);
+		return false;
+	}
+	auto &lstate = lstate_p.Cast<HttpdLogLocalState>();
+	lstate.range_active = true;
+	lstate.range_start = range_idx * SPLIT_SIZE;
+	lstate.range_end = MinValue<idx_t>(lstate.range_start + SPLIT_SIZE, split_file_size);
+	lstate.range_pending_rows = 0;
 	return true;
 }
 
+void HttpdLogFileReader::OpenRange(ClientContext &context, HttpdLogLocalState &lstate) {
+	auto &fs = FileSystem::GetFileSystem(context);
+	auto &buffer_manager = BufferManager::GetBufferManager(context);
+
+	HttpdLogReadBuffer buffer;
+	if (lstate.spare_buffer.IsSet()) {
+		buffer = std::move(lstate.spare_buffer);
+	} else {
+		buffer = HttpdLogReadBuffer(&buffer_manager, HttpdLogBufferedReader::BUFFER_SIZE,
+		                            HttpdLogBufferedReader::DIRECT_IO_ALIGNMENT);
+	}
+	// Ranges start at arbitrary offsets: no direct I/O
+	auto cache_mode = bind_data.cache_mode == HttpdLogCacheMode::DIRECT ? HttpdLogCacheMode::DROP_BEHIND
+	                                                                    : bind_data.cache_mode;
+	if (lstate.range_start == 0) {
+		lstate.range_reader = make_uniq<HttpdLogBufferedReader>(fs, file.path, std::move(buffer), cache_mode);
+		return;
+	}
+	// The line containing the byte before the range belongs to the previous range
+	lstate.range_reader =
+	    make_uniq<HttpdLogBufferedReader>(fs, file.path, std::move(buffer), cache_mode, lstate.range_start - 1);
+	lstate.range_reader->SkipLine();
+}
+
+bool HttpdLogFileReader::ReadRangeLine(HttpdLogLocalState &lstate, string &line) {
+	lstate.range_line_offset = lstate.range_reader->GetOffset();
+	if (lstate.range_line_offset >= lstate.range_end) {
+		return false;
+	}
+	return lstate.range_reader->ReadLine(line);
+}
+
+void HttpdLogFileReader::FinishRange(HttpdLogLocalState &lstate) {
+	lstate.range_active = false;
+	if (lstate.range_reader && !lstate.spare_buffer.IsSet() &&
+	    lstate.range_reader->GetBufferCapacity() == HttpdLogBufferedReader::BUFFER_SIZE) {
+		lstate.spare_buffer = lstate.range_reader->ReleaseBuffer();
+	}
+	lstate.range_reader.reset();
+}
+
+void HttpdLogFileReader::ScanMerge(HttpdLogGlobalState &gstate, HttpdLogLocalState &lstate, DataChunk &output) {
+	auto &merge = *gstate.merge;
+	idx_t output_idx = 0;
+	while (output_idx < STANDARD_VECTOR_SIZE) {
+		auto row = merge.Next(lstate);
+		if (!row) {
+			finished.store(true, std::memory_order_release);
+			break;
+		}
+		// Write the row with the file and line number of its source
+		merge_row_path = &merge.GetPath(row->file_idx);
+		current_line_number = row->line_number;
+		for (idx_t col_out_idx = 0; col_out_idx < column_ids.size(); col_out_idx++) {
+			idx_t schema_col_id = column_ids[MultiFileLocalIndex(col_out_idx)].GetId();
+			WriteColumnValue(output.data[col_out_idx], output_idx, schema_col_id, row->parsed_values, row->line,
+			                 row->parse_error, row->line_offset, &lstate.route_cache);
+		}
+		merge_row_path = nullptr;
+		output_idx++;
+	}
+	output.SetCardinality(output_idx);
+}
+
 void HttpdLogFileReader::Scan(ClientContext &context, GlobalTableFunctionState &global_state,
                               LocalTableFunctionState &local_state, DataChunk &output) {
-	if (finished.load(std::memory_order_acquire)) {
+	auto &lstate = local_state.Cast<HttpdLogLocalState>();
+	if (split_scan ? !lstate.range_active : finished.load(std::memory_order_acquire)) {
 		return;
 	}
 
@@ -356,7 +851,6 @@ void HttpdLogFileReader::Scan(ClientContext &context, GlobalTableFunctionState &
 	bool raw_mode = bind_data.raw_mode;
 
 	// Get thread-local parsing buffers for thread-safe RE2 matching
-	auto &lstate = local_state.Cast<HttpdLogLocalState>();
 	if (parsed_format.compiled_regex) {
 		int num_groups = parsed_format.compiled_regex->NumberOfCapturingGroups();
 		lstate.InitializeBuffers(num_groups);
@@ -365,18 +859,45 @@ void HttpdLogFileReader::Scan(ClientContext &context, GlobalTableFunctionState &
 	// Use column_ids from BaseFileReader (set by MultiFileColumnMapper)
 	auto &local_column_ids = column_ids;
 
-	while (output_idx < BATCH_SIZE && !finished.load(std::memory_order_acquire)) {
-		string line;
-		bool has_line = buffered_reader->ReadLine(line);
+	if (merge_host) {
+		ScanMerge(global_state.Cast<HttpdLogGlobalState>(), lstate, output);
+		return;
+	}
+
+	if (split_scan) {
+		if (!lstate.range_reader) {
+			OpenRange(context, lstate);
+		}
+	} else if (!buffered_reader && !reverse_reader) {
+		OpenReader(context, global_state.Cast<HttpdLogGlobalState>(), lstate);
+		if (!buffered_reader && !reverse_reader) {
+			// Unchanged since its checkpoint
+			FinishScan(lstate);
+			return;
+		}
+	}
+
+	// No column is read from the file (e.g. COUNT(*)): only the number of rows matters
+	if (local_column_ids.empty()) {
+		output.SetCardinality(ScanRowCount(lstate, BATCH_SIZE));
+		return;
+	}
+
+	// Reused across lines to keep its capacity
+	string line;
+	while (output_idx < BATCH_SIZE) {
+		// Updates the line number for every line read (including empty lines)
+		bool has_line = split_scan ? ReadRangeLine(lstate, line) : ReadNextLine(line);
 
 		if (!has_line) {
-			finished.store(true, std::memory_order_release);
+			if (split_scan) {
+				FinishRange(lstate);
+			} else {
+				FinishScan(lstate);
+			}
 			break;
 		}
 
-		// Increment line number for every line read (including empty lines)
-		current_line_number++;
-
 		if (line.empty()) {
 			continue;
 		}
@@ -391,6 +912,8 @@ void HttpdLogFileReader::Scan(ClientContext &context, GlobalTableFunctionState &
 			continue;
 		}
 
+		idx_t line_offset = split_scan ? lstate.range_line_offset : current_line_offset;
+
 		// Fill output chunk based on column_ids (projection pushdown)
 		for (idx_t col_out_idx = 0; col_out_idx < local_column_ids.size(); col_out_idx++) {
 			auto local_idx = MultiFileLocalIndex(col_out_idx);
@@ -398,7 +921,8 @@ void HttpdLogFileReader::Scan(ClientContext &context, GlobalTableFunctionState &
 			idx_t schema_col_id = local_id.GetId();
 
 			// Write the column value to output.data[col_out_idx]
-			WriteColumnValue(output.data[col_out_idx], output_idx, schema_col_id, parsed_values, line, parse_error);
+			WriteColumnValue(output.data[col_out_idx], output_idx, schema_col_id, parsed_values, line, parse_error,
+			                 line_offset, &lstate.route_cache);
 		}
 
 		output_idx++;
@@ -407,11 +931,65 @@ void HttpdLogFileReader::Scan(ClientContext &context, GlobalTableFunctionState &
 	output.SetCardinality(output_idx);
 }
 
+idx_t HttpdLogFileReader::ScanRowCount(HttpdLogLocalState &lstate, idx_t max_rows) {
+	const auto &parsed_format = bind_data.parsed_format;
+	// Split scans count per range, in the thread-local state
+	idx_t &pending = split_scan ? lstate.range_pending_rows : pending_row_count;
+
+	if (bind_data.count_lines && !block_sampling && !split_scan && !checkpoint_store) {
+		// count_mode='lines': count newlines a buffer at a time, emit in vector-sized pieces
+		while (pending < max_rows && !buffered_reader->Finished()) {
+			pending += buffered_reader->CountLines();
+		}
+	} else {
+		string line;
+		while (pending < max_rows) {
+			if (!(split_scan ? ReadRangeLine(lstate, line) : ReadNextLine(line))) {
+				break;
+			}
+			if (bind_data.count_lines) {
+				// Sampled or split count_mode='lines': lines end at range/block boundaries, count them one by one
+				pending++;
+				continue;
+			}
+			if (line.empty()) {
+				continue;
+			}
+			// Error rows are only produced in raw mode; otherwise the line must match
+			if (bind_data.raw_mode || HttpdLogFormatParser::MatchLogLine(line, parsed_format)) {
+				pending++;
+			}
+		}
+	}
+
+	idx_t row_count = MinValue<idx_t>(pending, max_rows);
+	pending -= row_count;
+	if (row_count == 0) {
+		if (split_scan) {
+			FinishRange(lstate);
+		} else {
+			FinishScan(lstate);
+		}
+	}
+	return row_count;
+}
+
 void HttpdLogFileReader::WriteColumnValue(Vector &vec, idx_t row_idx, idx_t schema_col_id,
-                                          const vector<string> &parsed_values, const string &line, bool parse_error) {
+                                          const vector<string> &parsed_values, const string &line, bool parse_error,
+                                          idx_t line_offset, optional_ptr<HttpdLogRouteCache> route_cache) {
 	const auto &parsed_format = bind_data.parsed_format;
 	bool raw_mode = bind_data.raw_mode;
 
+	if (schema_col_id >= schema_column_count) {
+		auto virtual_column_id = virtual_column_ids[schema_col_id - schema_column_count];
+		if (virtual_column_id == COLUMN_IDENTIFIER_ROUTE) {
+			WriteRouteValue(vec, row_idx, parsed_values, parse_error, route_cache);
+			return;
+		}
+		WriteVirtualColumnValue(vec, row_idx, virtual_column_id, line_offset);
+		return;
+	}
+
 	// Build a mapping from schema column ID to field/sub-column
 	// This needs to iterate through fields to find the right one
 	idx_t current_schema_col = 0;
@@ -551,15 +1129,29 @@ void HttpdLogFileReader::WriteColumnValue(Vector &vec, idx_t row_idx, idx_t sche
 	// Special columns: log_file, parse_error, raw_line
 	// log_file
 	if (current_schema_col == schema_col_id) {
-		FlatVector::GetData<string_t>(vec)[row_idx] = StringVector::AddString(vec, file.path);
+		const string &path = merge_row_path ? *merge_row_path : file.path;
+		FlatVector::GetData<string_t>(vec)[row_idx] = StringVector::AddString(vec, path);
 		return;
 	}
 	current_schema_col++;
 
+	// sample_fraction (sample=...)
+	if (bind_data.sampling) {
+		if (current_schema_col == schema_col_id) {
+			FlatVector::GetData<double>(vec)[row_idx] = sample_fraction;
+			return;
+		}
+		current_schema_col++;
+	}
+
 	if (raw_mode) {
-		// line_number
+		// line_number (unknown when sampling skipped part of the file)
 		if (current_schema_col == schema_col_id) {
-			FlatVector::GetData<int64_t>(vec)[row_idx] = static_cast<int64_t>(current_line_number);
+			if (line_numbers_known) {
+				FlatVector::GetData<int64_t>(vec)[row_idx] = static_cast<int64_t>(current_line_number);
+			} else {
+				FlatVector::SetNull(vec, row_idx, true);
+			}
 			return;
 		}
 		current_schema_col++;
@@ -579,6 +1171,36 @@ void HttpdLogFileReader::WriteColumnValue(Vector &vec, idx_t row_idx, idx_t sche
 	}
 }
 
+void HttpdLogFileReader::WriteVirtualColumnValue(Vector &vec, idx_t row_idx, column_t virtual_column_id,
+                                                 idx_t line_offset) {
+	if (virtual_column_id == COLUMN_IDENTIFIER_FILE_OFFSET) {
+		FlatVector::GetData<int64_t>(vec)[row_idx] = static_cast<int64_t>(line_offset);
+		return;
+	}
+	// line_number (unknown when sampling skipped part of the file)
+	if (line_numbers_known) {
+		FlatVector::GetData<int64_t>(vec)[row_idx] = static_cast<int64_t>(current_line_number);
+	} else {
+		FlatVector::SetNull(vec, row_idx, true);
+	}
+}
+
+void HttpdLogFileReader::WriteRouteValue(Vector &vec, idx_t row_idx, const vector<string> &parsed_values,
+                                         bool parse_error, optional_ptr<HttpdLogRouteCache> route_cache) {
+	string path;
+	if (parse_error || !ExtractPath(bind_data.parsed_format, parsed_values, path) || path.empty()) {
+		FlatVector::SetNull(vec, row_idx, true);
+		return;
+	}
+	if (route_cache) {
+		FlatVector::GetData<string_t>(vec)[row_idx] =
+		    StringVector::AddString(vec, route_cache->Get(bind_data.route_rules, path));
+	} else {
+		FlatVector::GetData<string_t>(vec)[row_idx] =
+		    StringVector::AddString(vec, HttpdLogRoute::Template(bind_data.route_rules, path));
+	}
+}
+
 void HttpdLogFileReader::WriteRegularFieldValue(Vector &vec, idx_t row_idx, const FormatField &field,
                                                 const string &value) {
 	if (field.type.id() == LogicalTypeId::VARCHAR) {
@@ -648,7 +648,8 @@ string HttpdLogFormatParser::GenerateRegexPattern(const ParsedFormat &parsed_for
 }
 
 void HttpdLogFormatParser::GenerateSchema(const ParsedFormat &parsed_format, vector<string> &names,
-                                          vector<LogicalType> &return_types, bool include_raw_columns) {
+                                          vector<LogicalType> &return_types, bool include_raw_columns,
+                                          bool include_sample_column) {
 	names.clear();
 	return_types.clear();
 
@@ -695,6 +696,12 @@ void HttpdLogFormatParser::GenerateSchema(const ParsedFormat &parsed_format, vec
 	names.push_back("log_file");
 	return_types.push_back(LogicalType::VARCHAR);
 
+	// sample_fraction is only included when block sampling is enabled
+	if (include_sample_column) {
+		names.push_back("sample_fraction");
+		return_types.push_back(LogicalType::DOUBLE);
+	}
+
 	// line_number, parse_error and raw_line are only included in raw mode
 	if (include_raw_columns) {
 		names.push_back("line_number");
@@ -846,6 +853,15 @@ vector<string> HttpdLogFormatParser::ParseLogLine(const string &line, const Pars
 	return ParseLogLine(line, parsed_format, matches, args, arg_ptrs);
 }
 
+bool HttpdLogFormatParser::MatchLogLine(const string &line, const ParsedFormat &parsed_format) {
+	// If no compiled regex (unknown format), every line is a parse error
+	if (!parsed_format.compiled_regex) {
+		return false;
+	}
+	// No capture arguments: RE2 only has to decide the match
+	return duckdb_re2::RE2::FullMatch(duckdb_re2::StringPiece(line), *parsed_format.compiled_regex);
+}
+
 // Helper to check if a directive is a request line variant (%r, %>r, %<r)
 static bool IsRequestLineDirective(const string &dir) {
 	return dir == "%r" || dir == "%>r" || dir == "%<r";
@@ -0,0 +1,93 @@
+#include "httpd_log_inflate_cache.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/extension/extension_loader.hpp"
+#include <cstring>
+
+namespace duckdb {
+
+void HttpdLogInflateCache::RegisterSetting(ExtensionLoader &loader) {
+	auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+	config.AddExtensionOption(SETTING_NAME,
+	                          "Memory for decompressed blocks of compressed log files kept across queries "
+	                          "(read_httpd_log), in addition to memory_limit; 0 disables the cache",
+	                          LogicalType::VARCHAR, Value("0"));
+}
+
+shared_ptr<HttpdLogInflateCache> HttpdLogInflateCache::Get(ClientContext &context) {
+	Value setting;
+	if (!context.TryGetCurrentSetting(SETTING_NAME, setting) || setting.IsNull()) {
+		return nullptr;
+	}
+	auto capacity = DBConfig::ParseMemoryLimit(setting.ToString());
+	auto &object_cache = ObjectCache::GetObjectCache(context);
+	if (capacity == 0) {
+		// Turning the cache off releases its memory
+		auto existing = object_cache.Get<HttpdLogInflateCache>(ObjectType());
+		if (existing) {
+			lock_guard<mutex> guard(existing->lock);
+			existing->capacity = 0;
+			existing->Evict();
+		}
+		return nullptr;
+	}
+	auto cache = object_cache.GetOrCreate<HttpdLogInflateCache>(ObjectType());
+	lock_guard<mutex> guard(cache->lock);
+	if (cache->capacity != capacity) {
+		cache->capacity = capacity;
+		cache->Evict();
+	}
+	return cache;
+}
+
+string HttpdLogInflateCache::FileIdentity(FileSystem &fs, FileHandle &handle, const string &path) {
+	auto mtime = fs.GetLastModifiedTime(handle);
+	return path + '\0' + to_string(handle.GetFileSize()) + '\0' + to_string(mtime.value);
+}
+
+shared_ptr<const HttpdLogInflateCache::Block> HttpdLogInflateCache::Lookup(const string &file_id, idx_t offset) {
+	auto key = file_id + '\0' + to_string(offset);
+	lock_guard<mutex> guard(lock);
+	auto entry = blocks.find(key);
+	if (entry == blocks.end()) {
+		return nullptr;
+	}
+	lru.splice(lru.begin(), lru, entry->second.position);
+	return entry->second.block;
+}
+
+void HttpdLogInflateCache::Insert(const string &file_id, idx_t offset, const char *data, idx_t size) {
+	auto key = file_id + '\0' + to_string(offset);
+	{
+		lock_guard<mutex> guard(lock);
+		if (size > capacity || blocks.find(key) != blocks.end()) {
+			return;
+		}
+	}
+	// Copy outside the lock: other scans keep reading from the cache meanwhile
+	auto block = make_shared_ptr<Block>();
+	block->data = make_unsafe_uniq_array_uninitialized<char>(MaxValue<idx_t>(size, 1));
+	block->size = size;
+	memcpy(block->data.get(), data, size);
+
+	lock_guard<mutex> guard(lock);
+	if (blocks.find(key) != blocks.end()) {
+		return;
+	}
+	lru.push_front(key);
+	blocks[key] = Entry {std::move(block), lru.begin()};
+	used_bytes += size;
+	Evict();
+}
+
+void HttpdLogInflateCache::Evict() {
+	while (used_bytes > capacity && !lru.empty()) {
+		auto entry = blocks.find(lru.back());
+		used_bytes -= entry->second.block->size;
+		blocks.erase(entry);
+		lru.pop_back();
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,233 @@
+#include "httpd_log_merge.hpp"
+#include "httpd_log_file_reader.hpp"
+#include "httpd_log_multi_file_info.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/config.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace duckdb {
+
+// Heap order: the input with the earliest row (then the earliest file) on top
+static bool RowAfter(const HttpdLogMerge::Row &a, const HttpdLogMerge::Row &b) {
+	if (a.timestamp != b.timestamp) {
+		return a.timestamp > b.timestamp;
+	}
+	return a.file_idx > b.file_idx;
+}
+
+HttpdLogMerge::HttpdLogMerge(ClientContext &context, const HttpdLogBindData &bind_data_p, vector<string> files_p)
+    : fs(FileSystem::GetFileSystem(context)), buffer_manager(BufferManager::GetBufferManager(context)),
+      temp_directory(DBConfig::GetConfig(context).options.temporary_directory), bind_data(bind_data_p),
+      files(std::move(files_p)) {
+}
+
+HttpdLogMerge::~HttpdLogMerge() {
+	final_pass.inputs.clear();
+	for (auto &run : runs) {
+		fs.TryRemoveFile(run);
+	}
+}
+
+// Run files hold one row per line: file index, line number, offset and timestamp, then the log line
+static void AppendRunRow(string &buffer, const HttpdLogMerge::Row &row) {
+	buffer += to_string(row.file_idx);
+	buffer += '\t';
+	buffer += to_string(row.line_number);
+	buffer += '\t';
+	buffer += to_string(row.line_offset);
+	buffer += '\t';
+	buffer += to_string(row.timestamp.value);
+	buffer += '\t';
+	buffer += row.line;
+	buffer += '\n';
+}
+
+static bool ParseRunRow(HttpdLogMerge::Row &row) {
+	const char *start = row.line.c_str();
+	char *end = nullptr;
+	row.file_idx = std::strtoull(start, &end, 10);
+	if (*end != '\t') {
+		return false;
+	}
+	row.line_number = std::strtoull(end + 1, &end, 10);
+	if (*end != '\t') {
+		return false;
+	}
+	row.line_offset = std::strtoull(end + 1, &end, 10);
+	if (*end != '\t') {
+		return false;
+	}
+	row.timestamp = timestamp_t(std::strtoll(end + 1, &end, 10));
+	if (*end != '\t') {
+		return false;
+	}
+	row.line.erase(0, NumericCast<idx_t>(end + 1 - start));
+	return true;
+}
+
+bool HttpdLogMerge::AdvanceInput(Input &input, bool parse_runs, HttpdLogLocalState &lstate) {
+	const auto &parsed_format = bind_data.parsed_format;
+	auto &row = input.row;
+	while (input.reader) {
+		if (!input.file_idx.IsValid()) {
+			// Run file: rows were filtered and timestamped by the pass that wrote it
+			if (!input.reader->ReadLine(row.line)) {
+				break;
+			}
+			if (!ParseRunRow(row)) {
+				throw IOException("assume_sorted: corrupt merge run file");
+			}
+			if (parse_runs) {
+				row.parsed_values = HttpdLogFormatParser::ParseLogLine(row.line, parsed_format, lstate.matches,
+				                                                       lstate.args, lstate.arg_ptrs);
+				row.parse_error = row.parsed_values.empty();
+			}
+			return true;
+		}
+		row.line_offset = input.reader->GetOffset();
+		if (!input.reader->ReadLine(row.line)) {
+			break;
+		}
+		row.line_number++;
+		if (row.line.empty()) {
+			continue;
+		}
+		row.parsed_values =
+		    HttpdLogFormatParser::ParseLogLine(row.line, parsed_format, lstate.matches, lstate.args, lstate.arg_ptrs);
+		row.parse_error = row.parsed_values.empty();
+		if (row.parse_error && !bind_data.raw_mode) {
+			continue;
+		}
+		timestamp_t timestamp;
+		if (!row.parse_error && HttpdLogFileReader::ExtractTimestamp(parsed_format, row.parsed_values, timestamp)) {
+			row.timestamp = timestamp;
+		}
+		return true;
+	}
+	// Done with this input: release its buffer and handle
+	input.reader.reset();
+	return false;
+}
+
+void HttpdLogMerge::OpenPass(Pass &pass, const vector<InputSource> &sources, bool parse_runs,
+                             HttpdLogLocalState &lstate) {
+	pass.inputs.resize(sources.size());
+	pass.parse_runs = parse_runs;
+	for (idx_t i = 0; i < sources.size(); i++) {
+		auto &input = pass.inputs[i];
+		input.file_idx = sources[i].file_idx;
+		if (input.file_idx.IsValid()) {
+			input.row.file_idx = input.file_idx.GetIndex();
+		}
+		// No inflate cache: it only keeps blocks of full-size buffers
+		input.reader = make_uniq<HttpdLogBufferedReader>(fs, sources[i].path,
+		                                                 HttpdLogReadBuffer(&buffer_manager, INPUT_BUFFER_SIZE));
+		if (AdvanceInput(input, parse_runs, lstate)) {
+			pass.heap.push_back(i);
+		}
+	}
+	std::make_heap(pass.heap.begin(), pass.heap.end(),
+	               [&pass](idx_t a, idx_t b) { return RowAfter(pass.inputs[a].row, pass.inputs[b].row); });
+}
+
+optional_ptr<const HttpdLogMerge::Row> HttpdLogMerge::NextRow(Pass &pass, HttpdLogLocalState &lstate) {
+	auto compare = [&pass](idx_t a, idx_t b) {
+		return RowAfter(pass.inputs[a].row, pass.inputs[b].row);
+	};
+	if (pass.current.IsValid()) {
+		// The row returned last has been consumed: move its input on
+		if (AdvanceInput(pass.inputs[pass.current.GetIndex()], pass.parse_runs, lstate)) {
+			pass.heap.push_back(pass.current.GetIndex());
+			std::push_heap(pass.heap.begin(), pass.heap.end(), compare);
+		}
+		pass.current = optional_idx();
+	}
+	if (pass.heap.empty()) {
+		return nullptr;
+	}
+	std::pop_heap(pass.heap.begin(), pass.heap.end(), compare);
+	pass.current = pass.heap.back();
+	pass.heap.pop_back();
+	return &pass.inputs[pass.current.GetIndex()].row;
+}
+
+string HttpdLogMerge::WriteRun(const vector<InputSource> &group, HttpdLogLocalState &lstate) {
+	if (temp_directory.empty()) {
+		throw InvalidInputException("assume_sorted over more than %d files merges them in several passes and "
+		                            "needs a temp_directory",
+		                            MAX_FAN_IN);
+	}
+	if (!fs.DirectoryExists(temp_directory)) {
+		fs.CreateDirectory(temp_directory);
+	}
+	// Unique across the merges of other queries, database instances and processes sharing the directory
+	auto path = fs.JoinPath(temp_directory, "httpd_log_merge_" + UUID::ToString(UUID::GenerateRandomUUID()) + ".tmp");
+	runs.push_back(path);
+	auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+
+	Pass pass;
+	OpenPass(pass, group, false, lstate);
+	string buffer;
+	while (true) {
+		auto row = NextRow(pass, lstate);
+		if (row) {
+			AppendRunRow(buffer, *row);
+		}
+		if (!row || buffer.size() >= RUN_WRITE_SIZE) {
+			handle->Write(const_cast<char *>(buffer.data()), buffer.size());
+			buffer.clear();
+		}
+		if (!row) {
+			break;
+		}
+	}
+	return path;
+}
+
+void HttpdLogMerge::Initialize(HttpdLogLocalState &lstate) {
+	initialized = true;
+	vector<InputSource> sources;
+	for (idx_t i = 0; i < files.size(); i++) {
+		sources.push_back(InputSource {files[i], i});
+	}
+	try {
+		while (sources.size() > MAX_FAN_IN) {
+			vector<InputSource> merged;
+			for (idx_t start = 0; start < sources.size(); start += MAX_FAN_IN) {
+				auto end = MinValue<idx_t>(start + MAX_FAN_IN, sources.size());
+				vector<InputSource> group(sources.begin() + NumericCast<int64_t>(start),
+				                          sources.begin() + NumericCast<int64_t>(end));
+				merged.push_back(InputSource {WriteRun(group, lstate), optional_idx()});
+				// The runs merged into the new run are no longer needed
+				for (auto &source : group) {
+					if (!source.file_idx.IsValid()) {
+						fs.TryRemoveFile(source.path);
+						runs.erase(std::find(runs.begin(), runs.end(), source.path));
+					}
+				}
+			}
+			sources = std::move(merged);
+		}
+		OpenPass(final_pass, sources, true, lstate);
+	} catch (...) {
+		// A failed pass (unreadable file, full disk) removes its runs right away, not when the merge is destroyed
+		final_pass.inputs.clear();
+		for (auto &run : runs) {
+			fs.TryRemoveFile(run);
+		}
+		runs.clear();
+		throw;
+	}
+}
+
+optional_ptr<const HttpdLogMerge::Row> HttpdLogMerge::Next(HttpdLogLocalState &lstate) {
+	if (!initialized) {
+		Initialize(lstate);
+	}
+	return NextRow(final_pass, lstate);
+}
+
+} // namespace duckdb
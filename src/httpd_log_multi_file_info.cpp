@@ -3,18 +3,33 @@
 #include "httpd_log_buffered_reader.hpp"
 #include "httpd_conf_reader.hpp"
 #include "duckdb/common/types/value.hpp"
+#include "duckdb/common/multi_file/multi_file_list.hpp"
 #include "duckdb/main/client_context.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/list.hpp"
+#include "duckdb/common/map.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include "duckdb/planner/expression/bound_between_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include <algorithm>
+#include <system_error>
 
 namespace duckdb {
 
+// Sample lines are short: read a small buffer instead of a full 2MB block per sampled file
+static constexpr idx_t SAMPLE_BUFFER_SIZE = 65536; // 64KB
+
 // Read sample lines from the first file for format auto-detection
 static vector<string> ReadSampleLines(ClientContext &context, const string &file_path, idx_t max_lines = 10) {
 	vector<string> sample_lines;
 	auto &fs = FileSystem::GetFileSystem(context);
 
 	try {
-		HttpdLogBufferedReader reader(fs, file_path);
+		HttpdLogBufferedReader reader(fs, file_path, SAMPLE_BUFFER_SIZE);
 		string line;
 		while (sample_lines.size() < max_lines && reader.ReadLine(line)) {
 			if (!line.empty()) {
@@ -28,6 +43,578 @@ static vector<string> ReadSampleLines(ClientContext &context, const string &file
 	return sample_lines;
 }
 
+// Compressed files cost more per byte on disk: decompression plus several bytes of text per compressed byte
+static constexpr idx_t COMPRESSED_COST_FACTOR = 4;
+// Longer file lists keep their order: with that many files, threads stay busy anyway, and sizing every file
+// would cost more than it saves
+static constexpr idx_t MAX_COST_ORDERED_FILES = 1024;
+
+// Size of a file as listed by the glob (extended info of remote file systems), without opening it
+static optional_idx ListedFileSize(const OpenFileInfo &file) {
+	if (!file.extended_info) {
+		return optional_idx();
+	}
+	auto entry = file.extended_info->options.find("file_size");
+	if (entry == file.extended_info->options.end()) {
+		return optional_idx();
+	}
+	auto size = entry->second;
+	if (size.IsNull() || !size.DefaultTryCastAs(LogicalType::UBIGINT)) {
+		return optional_idx();
+	}
+	return optional_idx(size.GetValue<uint64_t>());
+}
+
+// Size of a file: as listed, or from the file itself for local files (opening one is cheap)
+static optional_idx GetFileSize(FileSystem &fs, const OpenFileInfo &file) {
+	auto size = ListedFileSize(file);
+	if (size.IsValid() || FileSystem::IsRemoteFile(file.path)) {
+		return size;
+	}
+	try {
+		auto handle = fs.OpenFile(file.path, FileFlags::FILE_FLAGS_READ);
+		if (handle->CanSeek()) {
+			size = handle->GetFileSize();
+		}
+	} catch (...) {
+		// Unreadable files fail later in the scan with a proper error
+	}
+	return size;
+}
+
+// Reorder the file list so the most expensive files are read first
+// One reader handles a whole file, so a large file that starts last would leave a single thread running at the end
+// Only short lists of local files are reordered; others keep their (lazily expanded) order
+static void OrderFilesByScanCost(ClientContext &context, MultiFileBindData &bind_data) {
+	auto &file_list = *bind_data.file_list;
+	auto &fs = FileSystem::GetFileSystem(context);
+	vector<OpenFileInfo> files;
+	vector<pair<idx_t, idx_t>> costs; // (cost, original index)
+	for (idx_t i = 0;; i++) {
+		auto file = file_list.GetFile(i);
+		if (file.path.empty()) {
+			break;
+		}
+		if (i >= MAX_COST_ORDERED_FILES || FileSystem::IsRemoteFile(file.path)) {
+			return;
+		}
+		auto size = GetFileSize(fs, file);
+		if (!size.IsValid()) {
+			return;
+		}
+		auto cost = size.GetIndex();
+		if (HttpdLogBufferedReader::IsCompressedPath(file.path)) {
+			cost *= COMPRESSED_COST_FACTOR;
+		}
+		costs.emplace_back(cost, i);
+		files.push_back(std::move(file));
+	}
+	if (files.size() <= 1) {
+		return;
+	}
+	// Stable: files of equal cost keep the glob order
+	std::stable_sort(costs.begin(), costs.end(),
+	                 [](const pair<idx_t, idx_t> &a, const pair<idx_t, idx_t> &b) { return a.first > b.first; });
+
+	vector<OpenFileInfo> ordered;
+	ordered.reserve(files.size());
+	for (const auto &cost : costs) {
+		ordered.push_back(std::move(files[cost.second]));
+	}
+	bind_data.file_list = make_shared_ptr<SimpleMultiFileList>(std::move(ordered));
+}
+
+// skip_duplicates: files of equal size are compared on hashes of their first and last blocks of this size
+static constexpr idx_t FINGERPRINT_BLOCK_SIZE = 65536; // 64KB
+// skip_duplicates='content': whole files are hashed in chunks of this size
+static constexpr idx_t CONTENT_HASH_CHUNK_SIZE = 1048576; // 1MB
+
+//===--------------------------------------------------------------------===//
+// HttpdLogContentHashCache - Content hashes of files (skip_duplicates='content'), kept across queries
+// A file is only hashed again when its size or modification time changed. At most MAX_ENTRIES files are
+// remembered; the least recently used are dropped first
+//===--------------------------------------------------------------------===//
+class HttpdLogContentHashCache : public ObjectCacheEntry {
+public:
+	static constexpr idx_t MAX_ENTRIES = 65536;
+
+	static string ObjectType() {
+		return "httpd_log_content_hash_cache";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+	optional_idx GetEstimatedCacheMemory() const override {
+		return optional_idx(hashes.size() * (sizeof(Entry) + sizeof(string)));
+	}
+
+	//! The hash of a file, if it was hashed as it is now (identity: size and modification time)
+	bool Lookup(const string &path, const string &identity, hash_t &result) {
+		lock_guard<mutex> guard(lock);
+		auto entry = hashes.find(path);
+		if (entry == hashes.end() || entry->second.identity != identity) {
+			return false;
+		}
+		lru.splice(lru.begin(), lru, entry->second.position);
+		result = entry->second.hash;
+		return true;
+	}
+
+	//! Remember the hash of a file, replacing the hash of an earlier version of it
+	void Insert(const string &path, const string &identity, hash_t hash) {
+		lock_guard<mutex> guard(lock);
+		auto entry = hashes.find(path);
+		if (entry != hashes.end()) {
+			lru.erase(entry->second.position);
+			hashes.erase(entry);
+		}
+		lru.push_front(path);
+		hashes[path] = Entry {identity, hash, lru.begin()};
+		while (hashes.size() > MAX_ENTRIES) {
+			hashes.erase(lru.back());
+			lru.pop_back();
+		}
+	}
+
+private:
+	struct Entry {
+		string identity;
+		hash_t hash;
+		list<string>::iterator position;
+	};
+
+	mutex lock;
+	//! Most recently used first
+	list<string> lru;
+	unordered_map<string, Entry> hashes;
+};
+
+// Size and hashes of the first and last blocks of a file
+static hash_t FingerprintFile(FileHandle &handle, idx_t file_size, char *buffer) {
+	hash_t result = Hash(file_size);
+	idx_t head_size = MinValue<idx_t>(file_size, FINGERPRINT_BLOCK_SIZE);
+	handle.Read(buffer, head_size, 0);
+	result = CombineHash(result, Hash(buffer, head_size));
+	if (file_size > head_size) {
+		idx_t tail_size = MinValue<idx_t>(file_size - head_size, FINGERPRINT_BLOCK_SIZE);
+		handle.Read(buffer, tail_size, file_size - tail_size);
+		result = CombineHash(result, Hash(buffer, tail_size));
+	}
+	return result;
+}
+
+// Hash of the whole file, cached by path, size and modification time
+static hash_t HashFileContent(ClientContext &context, FileSystem &fs, FileHandle &handle, const string &path,
+                              idx_t file_size) {
+	auto cache = ObjectCache::GetObjectCache(context).GetOrCreate<HttpdLogContentHashCache>(
+	    HttpdLogContentHashCache::ObjectType());
+	auto identity = to_string(file_size) + '\0' + to_string(fs.GetLastModifiedTime(handle).value);
+	hash_t cached;
+	if (cache->Lookup(path, identity, cached)) {
+		return cached;
+	}
+	auto buffer = make_unsafe_uniq_array_uninitialized<char>(CONTENT_HASH_CHUNK_SIZE);
+	hash_t result = Hash(file_size);
+	for (idx_t offset = 0; offset < file_size; offset += CONTENT_HASH_CHUNK_SIZE) {
+		idx_t chunk_size = MinValue<idx_t>(file_size - offset, CONTENT_HASH_CHUNK_SIZE);
+		handle.Read(buffer.get(), chunk_size, offset);
+		result = CombineHash(result, Hash(buffer.get(), chunk_size));
+	}
+	cache->Insert(path, identity, result);
+	return result;
+}
+
+// Drop files that are byte-identical to an earlier file of the list (skip_duplicates)
+// Only files that share their size with another file are read
+static void SkipDuplicateFiles(ClientContext &context, MultiFileBindData &bind_data, HttpdLogDuplicateMode mode) {
+	auto files = bind_data.file_list->GetAllFiles();
+	if (files.size() <= 1) {
+		return;
+	}
+
+	auto &fs = FileSystem::GetFileSystem(context);
+	vector<optional_idx> sizes;
+	unordered_map<idx_t, idx_t> size_counts;
+	for (const auto &file : files) {
+		// The size listed by the glob when there is one: only files sharing their size are opened
+		auto size = ListedFileSize(file);
+		if (!size.IsValid()) {
+			try {
+				auto handle = fs.OpenFile(file.path, FileFlags::FILE_FLAGS_READ);
+				if (handle->CanSeek()) {
+					size = handle->GetFileSize();
+				}
+			} catch (...) {
+				// Unreadable files fail later in the scan with a proper error
+			}
+		}
+		if (size.IsValid()) {
+			size_counts[size.GetIndex()]++;
+		}
+		sizes.push_back(size);
+	}
+
+	auto buffer = make_unsafe_uniq_array_uninitialized<char>(FINGERPRINT_BLOCK_SIZE);
+	unordered_set<string> seen;
+	vector<OpenFileInfo> unique_files;
+	for (idx_t i = 0; i < files.size(); i++) {
+		if (!sizes[i].IsValid() || size_counts[sizes[i].GetIndex()] <= 1) {
+			unique_files.push_back(std::move(files[i]));
+			continue;
+		}
+		auto file_size = sizes[i].GetIndex();
+		auto handle = fs.OpenFile(files[i].path, FileFlags::FILE_FLAGS_READ);
+		auto key = to_string(file_size) + ":" + to_string(FingerprintFile(*handle, file_size, buffer.get()));
+		if (mode == HttpdLogDuplicateMode::CONTENT) {
+			key += ":" + to_string(HashFileContent(context, fs, *handle, files[i].path, file_size));
+		}
+		if (seen.insert(key).second) {
+			unique_files.push_back(std::move(files[i]));
+		}
+	}
+	bind_data.file_list = make_shared_ptr<SimpleMultiFileList>(std::move(unique_files));
+}
+
+// filename_time_pattern: number of digits of a strftime specifier in a file name (0: not supported)
+static idx_t FilenameTimeDigits(char specifier) {
+	switch (specifier) {
+	case 'Y':
+		return 4;
+	case 'm':
+	case 'd':
+	case 'H':
+	case 'M':
+	case 'S':
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+static void ValidateFilenameTimePattern(const string &pattern) {
+	bool has_year = false;
+	for (idx_t i = 0; i < pattern.size(); i++) {
+		if (pattern[i] != '%') {
+			continue;
+		}
+		if (i + 1 >= pattern.size()) {
+			throw BinderException("filename_time_pattern '%s' ends with %%", pattern);
+		}
+		auto specifier = pattern[++i];
+		if (specifier == '%') {
+			continue;
+		}
+		if (FilenameTimeDigits(specifier) == 0) {
+			throw BinderException("Invalid filename_time_pattern '%s': unsupported specifier %%%s. "
+			                      "Supported specifiers: %%Y %%m %%d %%H %%M %%S",
+			                      pattern, string(1, specifier));
+		}
+		has_year = has_year || specifier == 'Y';
+	}
+	if (!has_year) {
+		throw BinderException("Invalid filename_time_pattern '%s': the pattern must contain %%Y", pattern);
+	}
+}
+
+// Time in a file name: the pattern is matched at the first position of the name where it fits
+// match_start and match_end delimit the matched part of the name
+static bool ParseFilenameTime(const string &name, const string &pattern, timestamp_t &result, idx_t &match_start,
+                              idx_t &match_end) {
+	for (idx_t start = 0; start < name.size(); start++) {
+		int32_t year = 0, month = 1, day = 1, hour = 0, minute = 0, second = 0;
+		idx_t pos = start;
+		bool matched = true;
+		for (idx_t p = 0; p < pattern.size() && matched; p++) {
+			if (pattern[p] != '%' || pattern[p + 1] == '%') {
+				// Literal character (%% is a literal %)
+				if (pattern[p] == '%') {
+					p++;
+				}
+				matched = pos < name.size() && name[pos] == pattern[p];
+				pos++;
+				continue;
+			}
+			auto specifier = pattern[++p];
+			int32_t value = 0;
+			for (idx_t digit = 0; digit < FilenameTimeDigits(specifier); digit++, pos++) {
+				if (pos >= name.size() || !StringUtil::CharacterIsDigit(name[pos])) {
+					matched = false;
+					break;
+				}
+				value = value * 10 + (name[pos] - '0');
+			}
+			switch (specifier) {
+			case 'Y':
+				year = value;
+				break;
+			case 'm':
+				month = value;
+				break;
+			case 'd':
+				day = value;
+				break;
+			case 'H':
+				hour = value;
+				break;
+			case 'M':
+				minute = value;
+				break;
+			default:
+				second = value;
+				break;
+			}
+		}
+		if (!matched || !Date::IsValid(year, month, day) || hour > 23 || minute > 59 || second > 59) {
+			continue;
+		}
+		result = Timestamp::FromDatetime(Date::FromDate(year, month, day), Time::FromTime(hour, minute, second, 0));
+		match_start = start;
+		match_end = pos;
+		return true;
+	}
+	return false;
+}
+
+// Range of the timestamp column required by the filters of a scan
+struct TimestampBounds {
+	bool has_lower = false;
+	bool has_upper = false;
+	timestamp_t lower;
+	timestamp_t upper;
+
+	void SetLower(timestamp_t value) {
+		if (!has_lower || value > lower) {
+			lower = value;
+			has_lower = true;
+		}
+	}
+	void SetUpper(timestamp_t value) {
+		if (!has_upper || value < upper) {
+			upper = value;
+			has_upper = true;
+		}
+	}
+};
+
+static bool IsTimestampColumn(const LogicalGet &get, idx_t timestamp_idx, const Expression &expr) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+		return false;
+	}
+	auto &binding = expr.Cast<BoundColumnRefExpression>().binding;
+	auto &column_ids = get.GetColumnIds();
+	return binding.table_index == get.table_index && binding.column_index < column_ids.size() &&
+	       column_ids[binding.column_index].GetPrimaryIndex() == timestamp_idx;
+}
+
+static bool GetTimestampConstant(const Expression &expr, timestamp_t &result) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+		return false;
+	}
+	auto &value = expr.Cast<BoundConstantExpression>().value;
+	if (value.IsNull() || value.type().id() != LogicalTypeId::TIMESTAMP) {
+		return false;
+	}
+	result = value.GetValue<timestamp_t>();
+	return Timestamp::IsFinite(result);
+}
+
+// Bounds on timestamp from comparisons with constants (timestamp >= ..., BETWEEN ..., =); other filters are ignored
+static TimestampBounds GetTimestampBounds(const LogicalGet &get, idx_t timestamp_idx,
+                                          const vector<unique_ptr<Expression>> &filters) {
+	TimestampBounds bounds;
+	for (auto &filter : filters) {
+		timestamp_t constant;
+		if (filter->GetExpressionClass() == ExpressionClass::BOUND_BETWEEN) {
+			auto &between = filter->Cast<BoundBetweenExpression>();
+			if (!IsTimestampColumn(get, timestamp_idx, *between.input)) {
+				continue;
+			}
+			if (GetTimestampConstant(*between.lower, constant)) {
+				bounds.SetLower(constant);
+			}
+			if (GetTimestampConstant(*between.upper, constant)) {
+				bounds.SetUpper(constant);
+			}
+			continue;
+		}
+		if (filter->GetExpressionClass() != ExpressionClass::BOUND_COMPARISON) {
+			continue;
+		}
+		auto &comparison = filter->Cast<BoundComparisonExpression>();
+		auto type = comparison.GetExpressionType();
+		if (IsTimestampColumn(get, timestamp_idx, *comparison.right) &&
+		    GetTimestampConstant(*comparison.left, constant)) {
+			// constant < timestamp: the same as timestamp > constant
+			type = FlipComparisonExpression(type);
+		} else if (!IsTimestampColumn(get, timestamp_idx, *comparison.left) ||
+		           !GetTimestampConstant(*comparison.right, constant)) {
+			continue;
+		}
+		switch (type) {
+		case ExpressionType::COMPARE_EQUAL:
+			bounds.SetLower(constant);
+			bounds.SetUpper(constant);
+			break;
+		case ExpressionType::COMPARE_GREATERTHAN:
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			bounds.SetLower(constant);
+			break;
+		case ExpressionType::COMPARE_LESSTHAN:
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+			bounds.SetUpper(constant);
+			break;
+		default:
+			break;
+		}
+	}
+	return bounds;
+}
+
+// Names use the server's local time while timestamp is in UTC: windows are widened by a day on each side
+static constexpr int64_t FILENAME_TIME_MARGIN = Interval::MICROS_PER_DAY;
+
+// Which files can hold entries within the bounds, judging by the time in their names (filename_time_pattern)
+// Files of a series (same directory and name apart from the time and compression) are ordered by that time. A file
+// holds entries between the times of its neighbours: rotatelogs names a file after the start of its period,
+// logrotate (dateext) after the day it was rotated, i.e. the end of its period. The oldest and newest files of a
+// series are open-ended, and files without a time in their name are always kept.
+static vector<bool> FilesInTimeRange(const vector<string> &paths, const string &pattern,
+                                     const TimestampBounds &bounds) {
+	vector<bool> keep(paths.size(), true);
+	// series -> (time in the name, index in paths)
+	map<string, vector<pair<timestamp_t, idx_t>>> series;
+	for (idx_t i = 0; i < paths.size(); i++) {
+		auto name = StringUtil::GetFileName(paths[i]);
+		timestamp_t time;
+		idx_t match_start, match_end;
+		if (!ParseFilenameTime(name, pattern, time, match_start, match_end)) {
+			continue;
+		}
+		auto key = name.substr(0, match_start) + name.substr(match_end);
+		if (StringUtil::EndsWith(key, ".gz")) {
+			key = key.substr(0, key.size() - 3);
+		} else if (StringUtil::EndsWith(key, ".zst")) {
+			key = key.substr(0, key.size() - 4);
+		}
+		key = paths[i].substr(0, paths[i].size() - name.size()) + key;
+		series[key].emplace_back(time, i);
+	}
+	for (auto &entry : series) {
+		auto &files = entry.second;
+		std::sort(files.begin(), files.end());
+		for (idx_t i = 0; i < files.size(); i++) {
+			if (bounds.has_lower && i + 1 < files.size() &&
+			    files[i + 1].first.value + FILENAME_TIME_MARGIN < bounds.lower.value) {
+				keep[files[i].second] = false;
+			}
+			if (bounds.has_upper && i > 0 && files[i - 1].first.value - FILENAME_TIME_MARGIN > bounds.upper.value) {
+				keep[files[i].second] = false;
+			}
+		}
+	}
+	return keep;
+}
+
+// Drop the files outside the range of the timestamp filters (filename_time_pattern)
+static void PruneFilesByFilenameTime(LogicalGet &get, MultiFileBindData &bind_data,
+                                     const vector<unique_ptr<Expression>> &filters) {
+	auto &httpd_data = bind_data.bind_data->Cast<HttpdLogBindData>();
+	auto &names = httpd_data.schema_names;
+	auto timestamp_idx = NumericCast<idx_t>(std::find(names.begin(), names.end(), "timestamp") - names.begin());
+	auto bounds = GetTimestampBounds(get, timestamp_idx, filters);
+	if (!bounds.has_lower && !bounds.has_upper) {
+		return;
+	}
+
+	auto files = bind_data.file_list->GetAllFiles();
+	vector<string> paths;
+	for (auto &file : files) {
+		paths.push_back(file.path);
+	}
+	auto keep = FilesInTimeRange(paths, httpd_data.filename_time_pattern, bounds);
+	vector<OpenFileInfo> kept;
+	for (idx_t i = 0; i < keep.size(); i++) {
+		if (keep[i]) {
+			kept.push_back(files[i]);
+		}
+	}
+	if (kept.size() < files.size()) {
+		bind_data.file_list = make_shared_ptr<SimpleMultiFileList>(std::move(kept));
+		MultiFileReader::PruneReaders(bind_data, *bind_data.file_list);
+	}
+}
+
+// Files opened ahead by default when reading from a remote file system (open_ahead not specified)
+static constexpr idx_t DEFAULT_REMOTE_OPEN_AHEAD = 2;
+
+HttpdLogOpenAhead::HttpdLogOpenAhead(FileSystem &fs_p, BufferManager &buffer_manager_p,
+                                     shared_ptr<MultiFileList> file_list_p, idx_t window_p,
+                                     HttpdLogCacheMode cache_mode_p, shared_ptr<HttpdLogInflateCache> inflate_cache_p)
+    : fs(fs_p), buffer_manager(buffer_manager_p), file_list(std::move(file_list_p)), window(window_p),
+      cache_mode(cache_mode_p), inflate_cache(std::move(inflate_cache_p)) {
+}
+
+unique_ptr<HttpdLogBufferedReader> HttpdLogOpenAhead::Take(const string &path) {
+	std::future<unique_ptr<HttpdLogBufferedReader>> opened;
+	{
+		lock_guard<mutex> guard(lock);
+		files_taken++;
+		auto entry = pending.find(path);
+		if (entry != pending.end()) {
+			opened = std::move(entry->second);
+			pending.erase(entry);
+		}
+		taken.insert(path);
+
+		// Files are handed to readers in list order: open the next ones
+		while (next_file_idx < files_taken + window) {
+			// Throttle: opening ahead is an optimization, the buffers of running scans take precedence
+			if (buffer_manager.GetUsedMemory() + HttpdLogBufferedReader::BUFFER_SIZE > buffer_manager.GetMaxMemory()) {
+				break;
+			}
+			auto file = file_list->GetFile(next_file_idx);
+			if (file.path.empty()) {
+				break;
+			}
+			next_file_idx++;
+			if (taken.count(file.path) || pending.count(file.path)) {
+				continue;
+			}
+			auto &file_system = fs;
+			auto &manager = buffer_manager;
+			auto mode = cache_mode;
+			auto cache = inflate_cache;
+			auto file_path = file.path;
+			try {
+				pending.emplace(file_path,
+				                std::async(std::launch::async, [&file_system, &manager, mode, cache, file_path]() {
+					                return make_uniq<HttpdLogBufferedReader>(
+					                    file_system, file_path,
+					                    HttpdLogReadBuffer(&manager, HttpdLogBufferedReader::BUFFER_SIZE,
+					                                       HttpdLogBufferedReader::DIRECT_IO_ALIGNMENT),
+					                    mode, 0, cache);
+				                }));
+			} catch (std::system_error &) {
+				// No thread could be started: readers open their files themselves
+				window = 0;
+				break;
+			}
+		}
+	}
+
+	if (!opened.valid()) {
+		return nullptr;
+	}
+	try {
+		auto reader = opened.get();
+		files_opened_ahead++;
+		return reader;
+	} catch (...) {
+		// Let the reader open the file itself so the error is raised from the scan
+		return nullptr;
+	}
+}
+
 unique_ptr<MultiFileReaderInterface> HttpdLogMultiFileInfo::CreateInterface(ClientContext &context) {
 	return make_uniq<HttpdLogMultiFileInfo>();
 }
@@ -63,6 +650,90 @@ bool HttpdLogMultiFileInfo::ParseOption(ClientContext &context, const string &ke
 		options.raw_mode = BooleanValue::Get(value);
 		return true;
 	}
+	if (loption == "reverse") {
+		options.reverse = BooleanValue::Get(value);
+		return true;
+	}
+	if (loption == "sample") {
+		options.sample_rate = DoubleValue::Get(value.DefaultCastAs(LogicalType::DOUBLE));
+		if (!(options.sample_rate > 0 && options.sample_rate <= 1)) {
+			throw BinderException("sample must be a fraction in (0, 1], got %s", value.ToString());
+		}
+		options.sampling = true;
+		return true;
+	}
+	if (loption == "sample_seed") {
+		options.sample_seed = BigIntValue::Get(value.DefaultCastAs(LogicalType::BIGINT));
+		return true;
+	}
+	if (loption == "open_ahead") {
+		options.open_ahead = BigIntValue::Get(value.DefaultCastAs(LogicalType::BIGINT));
+		if (options.open_ahead < 0) {
+			throw BinderException("open_ahead must be a number of files >= 0, got %s", value.ToString());
+		}
+		return true;
+	}
+	if (loption == "cache_mode") {
+		auto mode = StringUtil::Lower(StringValue::Get(value));
+		if (mode == "default") {
+			options.cache_mode = HttpdLogCacheMode::DEFAULT;
+		} else if (mode == "drop_behind") {
+			options.cache_mode = HttpdLogCacheMode::DROP_BEHIND;
+		} else if (mode == "direct") {
+			options.cache_mode = HttpdLogCacheMode::DIRECT;
+		} else {
+			throw BinderException("Invalid cache_mode '%s'. Supported modes: 'default', 'drop_behind', 'direct'",
+			                      StringValue::Get(value));
+		}
+		return true;
+	}
+	if (loption == "assume_sorted") {
+		options.assume_sorted = BooleanValue::Get(value);
+		return true;
+	}
+	if (loption == "checkpoint_table") {
+		options.checkpoint_table = StringValue::Get(value);
+		if (options.checkpoint_table.empty()) {
+			throw BinderException("checkpoint_table must be a table name");
+		}
+		return true;
+	}
+	if (loption == "skip_duplicates") {
+		auto mode = StringUtil::Lower(StringValue::Get(value));
+		if (mode == "none") {
+			options.skip_duplicates = HttpdLogDuplicateMode::NONE;
+		} else if (mode == "fingerprint") {
+			options.skip_duplicates = HttpdLogDuplicateMode::FINGERPRINT;
+		} else if (mode == "content") {
+			options.skip_duplicates = HttpdLogDuplicateMode::CONTENT;
+		} else {
+			throw BinderException("Invalid skip_duplicates '%s'. Supported modes: 'none', 'fingerprint', 'content'",
+			                      StringValue::Get(value));
+		}
+		return true;
+	}
+	if (loption == "filename_time_pattern") {
+		options.filename_time_pattern = StringValue::Get(value);
+		ValidateFilenameTimePattern(options.filename_time_pattern);
+		return true;
+	}
+	if (loption == "route_rules") {
+		// Compiled here to reject invalid rules early; the bind data gets its own copy
+		HttpdLogRoute::ParseRules(value);
+		options.route_rules = value;
+		return true;
+	}
+	if (loption == "count_mode") {
+		auto mode = StringUtil::Lower(StringValue::Get(value));
+		if (mode == "lines") {
+			options.count_lines = true;
+		} else if (mode == "rows") {
+			options.count_lines = false;
+		} else {
+			throw BinderException("Invalid count_mode '%s'. Supported modes: 'rows', 'lines'", StringValue::Get(value));
+		}
+		return true;
+	}
 
 	return false;
 }
@@ -83,28 +754,51 @@ unique_ptr<TableFunctionData> HttpdLogMultiFileInfo::InitializeBindData(MultiFil
 	bind_data->format_str = std::move(options.format_str);
 	bind_data->conf = std::move(options.conf);
 	bind_data->raw_mode = options.raw_mode;
+	bind_data->count_lines = options.count_lines;
+	bind_data->reverse = options.reverse;
+	bind_data->sampling = options.sampling;
+	bind_data->sample_rate = options.sample_rate;
+	bind_data->sample_seed = options.sample_seed;
+	bind_data->open_ahead = options.open_ahead;
+	bind_data->cache_mode = options.cache_mode;
+	bind_data->assume_sorted = options.assume_sorted;
+	if (bind_data->assume_sorted && (bind_data->reverse || bind_data->sampling)) {
+		throw BinderException("assume_sorted cannot be combined with reverse or sample");
+	}
+	if (bind_data->reverse && bind_data->sampling) {
+		throw BinderException("reverse and sample cannot be combined");
+	}
+	bind_data->skip_duplicates = options.skip_duplicates;
+	bind_data->filename_time_pattern = std::move(options.filename_time_pattern);
+	if (!options.route_rules.IsNull()) {
+		bind_data->route_rules = HttpdLogRoute::ParseRules(options.route_rules);
+	}
+	bind_data->checkpoint_table = std::move(options.checkpoint_table);
+	if (!bind_data->checkpoint_table.empty() &&
+	    (bind_data->reverse || bind_data->sampling || bind_data->assume_sorted)) {
+		throw BinderException("checkpoint_table cannot be combined with reverse, sample or assume_sorted");
+	}
 
 	return std::move(bind_data);
 }
 
-void HttpdLogMultiFileInfo::BindReader(ClientContext &context, vector<LogicalType> &return_types, vector<string> &names,
-                                       MultiFileBindData &bind_data) {
-	auto &httpd_data = bind_data.bind_data->Cast<HttpdLogBindData>();
-
+void HttpdLogMultiFileInfo::BindFormat(ClientContext &context, HttpdLogBindData &httpd_data, MultiFileList &file_list) {
 	// Helper lambda to read sample lines from log files
+	// Iterates the file list lazily: a glob is only expanded as far as the files that are sampled
 	auto get_sample_lines = [&]() -> vector<string> {
-		auto expanded_files = bind_data.file_list->GetAllFiles();
-		if (expanded_files.empty()) {
-			throw BinderException("No files found for httpd log reading");
-		}
 		vector<string> sample_lines;
-		for (const auto &file_info : expanded_files) {
+		bool has_files = false;
+		for (const auto &file_info : file_list.Files()) {
+			has_files = true;
 			auto lines = ReadSampleLines(context, file_info.path, 10);
 			sample_lines.insert(sample_lines.end(), lines.begin(), lines.end());
 			if (sample_lines.size() >= 10) {
 				break;
 			}
 		}
+		if (!has_files) {
+			throw BinderException("No files found for httpd log reading");
+		}
 		return sample_lines;
 	};
 
@@ -224,27 +918,67 @@ void HttpdLogMultiFileInfo::BindReader(ClientContext &context, vector<LogicalTyp
 			httpd_data.raw_mode = true; // Force raw mode for unknown format
 		}
 	}
+}
+
+void HttpdLogMultiFileInfo::BindReader(ClientContext &context, vector<LogicalType> &return_types, vector<string> &names,
+                                       MultiFileBindData &bind_data) {
+	auto &httpd_data = bind_data.bind_data->Cast<HttpdLogBindData>();
+
+	// Resolve the log format (format_str, conf, format_type or auto-detection)
+	BindFormat(context, httpd_data, *bind_data.file_list);
 
 	// Generate schema from parsed format
-	HttpdLogFormatParser::GenerateSchema(httpd_data.parsed_format, names, return_types, httpd_data.raw_mode);
+	HttpdLogFormatParser::GenerateSchema(httpd_data.parsed_format, names, return_types, httpd_data.raw_mode,
+	                                     httpd_data.sampling);
+	httpd_data.schema_names = names;
+	httpd_data.schema_types = return_types;
+	if (!httpd_data.filename_time_pattern.empty() &&
+	    std::find(names.begin(), names.end(), "timestamp") == names.end()) {
+		throw BinderException("filename_time_pattern requires a log format with a timestamp (%t)");
+	}
+	if (!httpd_data.route_rules.empty() && std::find(names.begin(), names.end(), "path") == names.end()) {
+		throw BinderException("route_rules requires a log format with a request path (%r or %U)");
+	}
+
+	if (httpd_data.skip_duplicates != HttpdLogDuplicateMode::NONE) {
+		SkipDuplicateFiles(context, bind_data, httpd_data.skip_duplicates);
+	}
+
+	if (!httpd_data.assume_sorted && !DBConfig::GetConfig(context).options.preserve_insertion_order) {
+		// Largest-first scheduling, unless rows have to come out in file order (or are merged by timestamp)
+		OrderFilesByScanCost(context, bind_data);
+	}
 
 	// Let MultiFileReader handle options like filename, hive partitioning, etc.
 	bind_data.multi_file_reader->BindOptions(bind_data.file_options, *bind_data.file_list, return_types, names,
 	                                         bind_data.reader_bind);
+
+	// The multi-file reader fills these columns per reader, while one reader emits the merged rows of all files
+	if (httpd_data.assume_sorted && (bind_data.file_options.filename || bind_data.file_options.hive_partitioning)) {
+		throw BinderException("assume_sorted cannot be combined with filename or hive_partitioning (use the log_file "
+		                      "column; hive partitions can be disabled with hive_partitioning=false)");
+	}
 }
 
 optional_idx HttpdLogMultiFileInfo::MaxThreads(const MultiFileBindData &bind_data_p,
                                                const MultiFileGlobalState &global_state,
                                                FileExpandResult expand_result) {
+	if (bind_data_p.bind_data->Cast<HttpdLogBindData>().assume_sorted) {
+		// The merge of all files runs on one thread
+		return 1;
+	}
 	// Thread-safety: Now safe for parallel file reading because:
 	// 1. scan_initialized/finished flags use std::atomic<bool> with compare_exchange
 	// 2. RE2 parsing buffers are in HttpdLogLocalState (thread-local per thread)
 	// 3. Each HttpdLogFileReader has its own buffered_reader instance
 	if (expand_result == FileExpandResult::MULTIPLE_FILES) {
-		// Multiple files: allow parallel processing (one thread per file)
+		// Multiple files: allow parallel processing (one thread per file, or per range of a split file)
 		return optional_idx();
 	}
-	// Single file: no intra-file parallelism (unlike Parquet row groups)
+	// Single file: one thread per range when the file is split (like Parquet row groups)
+	if (global_state.global_state) {
+		return global_state.global_state->Cast<HttpdLogGlobalState>().single_file_ranges;
+	}
 	return 1;
 }
 
@@ -256,6 +990,62 @@ unique_ptr<GlobalTableFunctionState> HttpdLogMultiFileInfo::InitializeGlobalStat
 	// Store column_ids for projection pushdown (like read_file pattern)
 	for (idx_t i = 0; i < global_state.column_indexes.size(); i++) {
 		result->column_ids.push_back(global_state.column_indexes[i].GetPrimaryIndex());
+		if (result->column_ids.back() == HttpdLogFileReader::COLUMN_IDENTIFIER_LINE_NUMBER) {
+			result->line_number_projected = true;
+		}
+	}
+
+	auto &httpd_data = bind_data.bind_data->Cast<HttpdLogBindData>();
+
+	// A single large file is split into ranges scanned in parallel
+	if (bind_data.file_list->GetExpandResult() == FileExpandResult::SINGLE_FILE) {
+		auto path = bind_data.file_list->GetFile(0).path;
+		if (!result->line_number_projected && HttpdLogFileReader::CanSplit(httpd_data, path)) {
+			try {
+				auto handle = FileSystem::GetFileSystem(context).OpenFile(path, FileFlags::FILE_FLAGS_READ);
+				result->single_file_ranges = HttpdLogFileReader::RangeCount(handle->GetFileSize());
+			} catch (...) {
+				// The scan reports the error
+			}
+		}
+	}
+
+	// Files resume where the previous scan stopped (checkpoint_table)
+	if (!httpd_data.checkpoint_table.empty()) {
+		result->checkpoints = make_uniq<HttpdLogCheckpointStore>(context, httpd_data.checkpoint_table);
+	}
+
+	// Decompressed blocks of compressed files are reused across queries
+	result->inflate_cache = HttpdLogInflateCache::Get(context);
+
+	// Merge the files that are left after pruning (filename_time_pattern, hive partitions) by timestamp
+	if (httpd_data.assume_sorted && global_state.file_list.GetExpandResult() == FileExpandResult::MULTIPLE_FILES) {
+		vector<string> paths;
+		for (auto &file : global_state.file_list.Files()) {
+			paths.push_back(file.path);
+		}
+		if (paths.size() > 1) {
+			result->merge = make_uniq<HttpdLogMerge>(context, httpd_data, std::move(paths));
+		}
+	}
+
+	// Open upcoming files in the background (only plain forward scans read the file from its start)
+	if (!httpd_data.reverse && !httpd_data.sampling && !result->checkpoints && !result->merge) {
+		idx_t window = 0;
+#ifndef DUCKDB_NO_THREADS
+		// Files are opened ahead on threads of their own: not in builds without threads
+		if (httpd_data.open_ahead >= 0) {
+			window = NumericCast<idx_t>(httpd_data.open_ahead);
+		} else if (FileSystem::IsRemoteFile(bind_data.file_list->GetFile(0).path)) {
+			window = DEFAULT_REMOTE_OPEN_AHEAD;
+		}
+#endif
+		if (window > 0) {
+			result->open_ahead =
+			    make_uniq<HttpdLogOpenAhead>(FileSystem::GetFileSystem(context),
+			                                 BufferManager::GetBufferManager(context), bind_data.file_list, window,
+			                                 httpd_data.cache_mode, result->inflate_cache);
+		}
 	}
 
 	return std::move(result);
@@ -289,9 +1079,103 @@ shared_ptr<BaseFileReader> HttpdLogMultiFileInfo::CreateReader(ClientContext &co
 	throw NotImplementedException("HttpdLogMultiFileInfo::CreateReader with options not implemented");
 }
 
+// Bind index of the log_file column, if the scan produces one value of it per batch
+static optional_idx LogFileColumnIndex(const MultiFileBindData &bind_data) {
+	auto &httpd_data = bind_data.bind_data->Cast<HttpdLogBindData>();
+	if (httpd_data.assume_sorted) {
+		// assume_sorted merges rows of all files into one batch
+		return optional_idx();
+	}
+	for (idx_t i = 0; i < httpd_data.schema_names.size(); i++) {
+		if (httpd_data.schema_names[i] == "log_file") {
+			return i;
+		}
+	}
+	return optional_idx();
+}
+
+// Whether all partition columns are log_file
+static bool PartitionsOnLogFile(const MultiFileBindData &bind_data, const vector<column_t> &partition_ids) {
+	auto log_file_idx = LogFileColumnIndex(bind_data);
+	if (!log_file_idx.IsValid() || partition_ids.empty()) {
+		return false;
+	}
+	for (auto &partition_id : partition_ids) {
+		if (partition_id != log_file_idx.GetIndex()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TablePartitionInfo HttpdLogMultiFileInfo::GetPartitionInfo(ClientContext &context, TableFunctionPartitionInput &input) {
+	auto &bind_data = input.bind_data->Cast<MultiFileBindData>();
+	if (PartitionsOnLogFile(bind_data, input.partition_ids)) {
+		return TablePartitionInfo::SINGLE_VALUE_PARTITIONS;
+	}
+	return MultiFileFunction<HttpdLogMultiFileInfo>::MultiFileGetPartitionInfo(context, input);
+}
+
+OperatorPartitionData HttpdLogMultiFileInfo::GetPartitionData(ClientContext &context,
+                                                              TableFunctionGetPartitionInput &input) {
+	auto &bind_data = input.bind_data->Cast<MultiFileBindData>();
+	if (!input.partition_info.RequiresPartitionColumns() ||
+	    !PartitionsOnLogFile(bind_data, input.partition_info.partition_columns)) {
+		return MultiFileFunction<HttpdLogMultiFileInfo>::MultiFileGetPartitionData(context, input);
+	}
+	auto &data = input.local_state->Cast<MultiFileLocalState>();
+	OperatorPartitionData partition_data(data.batch_index);
+	Value log_file(data.reader->GetFileName());
+	for (idx_t i = 0; i < input.partition_info.partition_columns.size(); i++) {
+		partition_data.partition_data.emplace_back(log_file);
+	}
+	return partition_data;
+}
+
+InsertionOrderPreservingMap<string> HttpdLogMultiFileInfo::DynamicToString(TableFunctionDynamicToStringInput &input) {
+	auto result = MultiFileFunction<HttpdLogMultiFileInfo>::MultiFileDynamicToString(input);
+	if (!input.global_state) {
+		return result;
+	}
+	auto &gstate = input.global_state->Cast<MultiFileGlobalState>();
+	if (!gstate.global_state) {
+		return result;
+	}
+	auto &httpd_gstate = gstate.global_state->Cast<HttpdLogGlobalState>();
+	if (httpd_gstate.open_ahead) {
+		result["Files Opened Ahead"] = to_string(httpd_gstate.open_ahead->FilesOpenedAhead());
+	}
+	return result;
+}
+
+void HttpdLogMultiFileInfo::PushdownComplexFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                                  vector<unique_ptr<Expression>> &filters) {
+	auto &bind_data = bind_data_p->Cast<MultiFileBindData>();
+	if (!bind_data.bind_data->Cast<HttpdLogBindData>().filename_time_pattern.empty()) {
+		PruneFilesByFilenameTime(get, bind_data, filters);
+	}
+	MultiFileFunction<HttpdLogMultiFileInfo>::MultiFileComplexFilterPushdown(context, get, bind_data_p, filters);
+}
+
 unique_ptr<NodeStatistics> HttpdLogMultiFileInfo::GetCardinality(const MultiFileBindData &bind_data, idx_t file_count) {
 	// Estimate average log file has ~10000 lines
 	return make_uniq<NodeStatistics>(file_count * 10000);
 }
 
+void HttpdLogMultiFileInfo::GetVirtualColumns(ClientContext &context, MultiFileBindData &bind_data,
+                                              virtual_column_map_t &result) {
+	result.insert(make_pair(HttpdLogFileReader::COLUMN_IDENTIFIER_FILE_OFFSET,
+	                        TableColumn("file_offset", LogicalType::BIGINT)));
+	auto &httpd_data = bind_data.bind_data->Cast<HttpdLogBindData>();
+	if (!httpd_data.raw_mode) {
+		result.insert(make_pair(HttpdLogFileReader::COLUMN_IDENTIFIER_LINE_NUMBER,
+		                        TableColumn("line_number", LogicalType::BIGINT)));
+	}
+	auto &names = httpd_data.schema_names;
+	if (std::find(names.begin(), names.end(), "path") != names.end()) {
+		result.insert(
+		    make_pair(HttpdLogFileReader::COLUMN_IDENTIFIER_ROUTE, TableColumn("route", LogicalType::VARCHAR)));
+	}
+}
+
 } // namespace duckdb
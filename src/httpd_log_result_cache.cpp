@@ -0,0 +1,298 @@
+#include "httpd_log_result_cache.hpp"
+#include "httpd_log_checkpoint.hpp"
+#include "httpd_log_multi_file_info.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/multi_file/multi_file_reader.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/unordered_set.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/client_context_state.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/prepared_statement.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/parser/tableref/subqueryref.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+namespace duckdb {
+
+// Cache databases attached to a database instance (ObjectCache), and the queries using them
+class HttpdLogCacheRegistry : public ObjectCacheEntry {
+public:
+	//! Refreshes are serialized: two queries caching the same file at once would insert its rows twice
+	mutex refresh_lock;
+	//! Queries reading from each attached cache database (guarded by refresh_lock): the last one to end detaches it
+	unordered_map<string, idx_t> readers;
+
+	static shared_ptr<HttpdLogCacheRegistry> Get(ClientContext &context) {
+		return ObjectCache::GetObjectCache(context).GetOrCreate<HttpdLogCacheRegistry>(ObjectType());
+	}
+
+	static string ObjectType() {
+		return "httpd_log_cache_registry";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+	optional_idx GetEstimatedCacheMemory() const override {
+		return optional_idx();
+	}
+};
+
+// Cache databases read by the queries of a client context: they are detached once the queries, and the
+// transaction they ran in, have ended, so the cache does not stay in the catalog
+struct HttpdLogCacheAttachments : public ClientContextState {
+	static constexpr const char *KEY = "httpd_log_cache_attachments";
+
+	unordered_set<string> databases;
+
+	void QueryEnd(ClientContext &context) override {
+		if (databases.empty() || context.transaction.HasActiveTransaction()) {
+			return;
+		}
+		auto registry = HttpdLogCacheRegistry::Get(context);
+		lock_guard<mutex> guard(registry->refresh_lock);
+		Connection connection(*context.db);
+		for (auto &database : databases) {
+			auto entry = registry->readers.find(database);
+			if (entry == registry->readers.end() || --entry->second > 0) {
+				continue;
+			}
+			registry->readers.erase(entry);
+			// Errors are not reported at the end of a query; the database is detached again by the next one
+			connection.Query("DETACH DATABASE IF EXISTS " + database);
+		}
+		databases.clear();
+	}
+};
+
+// A file of the scan, as it is on disk now
+struct CacheFile {
+	string path;
+	idx_t file_size = 0;
+	timestamp_t mtime;
+};
+
+static unique_ptr<MaterializedQueryResult> RunQuery(Connection &connection, const string &query) {
+	auto result = connection.Query(query);
+	if (result->HasError()) {
+		result->ThrowError("cache_dir: ");
+	}
+	return result;
+}
+
+static string HexString(hash_t value) {
+	static constexpr const char *DIGITS = "0123456789abcdef";
+	string result;
+	for (idx_t shift = 64; shift > 0; shift -= 4) {
+		result += DIGITS[(value >> (shift - 4)) & 0xF];
+	}
+	return result;
+}
+
+// Comma-separated list of quoted file names
+static string FileList(const vector<CacheFile> &files) {
+	vector<string> quoted;
+	for (auto &file : files) {
+		quoted.push_back(KeywordHelper::WriteQuoted(file.path, '\''));
+	}
+	return StringUtil::Join(quoted, ", ");
+}
+
+// Parse the new and changed files into the cache
+// Files that grew after a complete last line are read from their checkpoint on (new lines appended); other
+// changed files are parsed again
+static void RefreshFiles(Connection &connection, FileSystem &fs, const vector<CacheFile> &stale,
+                         const string &rows_table, const string &files_table, const string &scan_options) {
+	auto rows = HttpdLogCheckpointStore::QuoteTableName(rows_table);
+	auto files = HttpdLogCheckpointStore::QuoteTableName(files_table);
+	auto &pending = *connection.context->registered_state->Get<HttpdLogPendingCheckpoints>(
+	    HttpdLogPendingCheckpoints::KEY);
+
+	// Sizes the files had when they were cached, and where their checkpoints stopped
+	unordered_map<string, pair<idx_t, idx_t>> cached_files;
+	auto cached = RunQuery(connection, "SELECT log_file, file_size, file_offset FROM " + files);
+	for (idx_t row = 0; row < cached->RowCount(); row++) {
+		cached_files[cached->GetValue(0, row).ToString()] =
+		    make_pair(cached->GetValue(1, row).GetValue<idx_t>(), cached->GetValue(2, row).GetValue<idx_t>());
+	}
+
+	// What the checkpoints cannot extend is replaced: the scan reads these files from their start. A file cached
+	// with a partial last line has that line among its rows, so it is parsed again too
+	vector<string> replaced;
+	{
+		HttpdLogCheckpointStore store(*connection.context, files_table);
+		for (auto &file : stale) {
+			auto entry = cached_files.find(file.path);
+			if (entry == cached_files.end()) {
+				continue;
+			}
+			auto cached_size = entry->second.first;
+			bool extend = !HttpdLogBufferedReader::IsCompressedPath(file.path) && file.file_size > cached_size &&
+			              entry->second.second == cached_size && store.Plan(fs, file.path).start_offset > 0;
+			if (!extend) {
+				replaced.push_back(file.path);
+				pending.restart_files.insert(file.path);
+			}
+		}
+	}
+
+	// The rows and the checkpoints they extend are committed together, with the rows they replace
+	connection.BeginTransaction();
+	try {
+		for (auto &path : replaced) {
+			auto log_file = KeywordHelper::WriteQuoted(path, '\'');
+			RunQuery(connection, "DELETE FROM " + rows + " WHERE log_file = " + log_file);
+			RunQuery(connection, "DELETE FROM " + files + " WHERE log_file = " + log_file);
+		}
+		RunQuery(connection, "INSERT INTO " + rows + " SELECT * FROM read_httpd_log([" + FileList(stale) + "]" +
+		                         scan_options + ", checkpoint_table := " +
+		                         KeywordHelper::WriteQuoted(files_table, '\'') + ")");
+
+		unordered_map<string, timestamp_t> mtimes;
+		for (auto &file : stale) {
+			mtimes[file.path] = file.mtime;
+		}
+		auto upsert = connection.Prepare("INSERT OR REPLACE INTO " + files + " VALUES ($1, $2, $3, $4, $5, $6, $7)");
+		if (upsert->HasError()) {
+			throw BinderException("cache_dir: %s has an unexpected layout: %s", files_table, upsert->GetError());
+		}
+		for (auto &entry : pending.checkpoints) {
+			auto &checkpoint = entry.second;
+			vector<Value> values {Value(entry.first),
+			                      Value::UBIGINT(checkpoint.inode),
+			                      Value::BIGINT(NumericCast<int64_t>(checkpoint.file_size)),
+			                      Value::BIGINT(NumericCast<int64_t>(checkpoint.file_offset)),
+			                      Value::BIGINT(NumericCast<int64_t>(checkpoint.line_number)),
+			                      Value::UBIGINT(checkpoint.head_hash),
+			                      Value::TIMESTAMP(mtimes[entry.first])};
+			auto result = upsert->Execute(values, false);
+			if (result->HasError()) {
+				result->ThrowError("cache_dir: ");
+			}
+		}
+		connection.Commit();
+	} catch (...) {
+		if (connection.HasActiveTransaction()) {
+			connection.Rollback();
+		}
+		throw;
+	}
+}
+
+unique_ptr<TableRef> HttpdLogResultCache::BindReplace(ClientContext &context, TableFunctionBindInput &input) {
+	auto cache_entry = input.named_parameters.find("cache_dir");
+	if (cache_entry == input.named_parameters.end()) {
+		return nullptr;
+	}
+	if (cache_entry->second.IsNull() || StringValue::Get(cache_entry->second).empty()) {
+		throw BinderException("cache_dir must be a directory");
+	}
+	auto cache_dir = StringValue::Get(cache_entry->second);
+
+	// Only options that decide the rows of a file: the cached rows are served for any of them
+	HttpdLogBindData httpd_data;
+	for (auto &param : input.named_parameters) {
+		if (param.second.IsNull()) {
+			throw BinderException("Cannot use NULL as argument to key %s", param.first);
+		}
+		auto loption = StringUtil::Lower(param.first);
+		if (loption == "format_type") {
+			httpd_data.format_type = StringValue::Get(param.second);
+		} else if (loption == "format_str") {
+			httpd_data.format_str = StringValue::Get(param.second);
+		} else if (loption == "conf") {
+			httpd_data.conf = StringValue::Get(param.second);
+		} else if (loption == "raw") {
+			httpd_data.raw_mode = BooleanValue::Get(param.second);
+		} else if (loption != "cache_dir") {
+			throw BinderException("cache_dir cannot be combined with %s", param.first);
+		}
+	}
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("read_httpd_log: path cannot be NULL");
+	}
+
+	auto multi_file_reader = MultiFileReader::Create(input.table_function);
+	auto file_list = multi_file_reader->CreateFileList(context, input.inputs[0]);
+	HttpdLogMultiFileInfo::BindFormat(context, httpd_data, *file_list);
+	if (httpd_data.format_str.empty()) {
+		throw BinderException("cache_dir: could not determine the log format, specify format_type, format_str or conf");
+	}
+
+	// Rows are kept per format: the same file read with another format (or raw) is cached separately
+	auto format_key = HexString(CombineHash(Hash(httpd_data.format_str.c_str(), httpd_data.format_str.size()),
+	                                        Hash(static_cast<uint64_t>(httpd_data.raw_mode))));
+	auto database = "httpd_log_cache_" + HexString(Hash(cache_dir.c_str(), cache_dir.size()));
+	auto rows_table = database + ".rows_" + format_key;
+	auto files_table = database + ".files_" + format_key;
+	auto scan_options = ", format_str := " + KeywordHelper::WriteQuoted(httpd_data.format_str, '\'') +
+	                    ", raw := " + (httpd_data.raw_mode ? "true" : "false");
+
+	// Files as they are now; a file whose size and modification time are unchanged is served as cached
+	auto &fs = FileSystem::GetFileSystem(context);
+	vector<CacheFile> files;
+	for (auto &file_info : file_list->Files()) {
+		CacheFile file;
+		file.path = file_info.path;
+		auto handle = fs.OpenFile(file.path, FileFlags::FILE_FLAGS_READ);
+		file.file_size = handle->GetFileSize();
+		file.mtime = fs.GetLastModifiedTime(*handle);
+		files.push_back(std::move(file));
+	}
+
+	{
+		auto registry = HttpdLogCacheRegistry::Get(context);
+		lock_guard<mutex> guard(registry->refresh_lock);
+		if (!fs.DirectoryExists(cache_dir)) {
+			fs.CreateDirectory(cache_dir);
+		}
+		Connection connection(*context.db);
+		auto pending = make_shared_ptr<HttpdLogPendingCheckpoints>();
+		pending->follow_renames = false;
+		pending->read_partial_line = true;
+		connection.context->registered_state->Insert(HttpdLogPendingCheckpoints::KEY, pending);
+
+		RunQuery(connection, "ATTACH IF NOT EXISTS " +
+		                         KeywordHelper::WriteQuoted(fs.JoinPath(cache_dir, CACHE_FILE_NAME), '\'') + " AS " +
+		                         database);
+		auto attachments =
+		    context.registered_state->GetOrCreate<HttpdLogCacheAttachments>(HttpdLogCacheAttachments::KEY);
+		if (attachments->databases.insert(database).second) {
+			registry->readers[database]++;
+		}
+		RunQuery(connection, "CREATE TABLE IF NOT EXISTS " + files_table +
+		                         " (log_file VARCHAR PRIMARY KEY, inode UBIGINT, file_size BIGINT, "
+		                         "file_offset BIGINT, line_number BIGINT, head_hash UBIGINT, mtime TIMESTAMP)");
+		RunQuery(connection, "CREATE TABLE IF NOT EXISTS " + rows_table + " AS SELECT * FROM read_httpd_log(" +
+		                         KeywordHelper::WriteQuoted(files[0].path, '\'') + scan_options + ") LIMIT 0");
+
+		unordered_map<string, pair<idx_t, timestamp_t>> cached;
+		auto result = RunQuery(connection, "SELECT log_file, file_size, mtime FROM " + files_table);
+		for (idx_t row = 0; row < result->RowCount(); row++) {
+			cached[result->GetValue(0, row).ToString()] =
+			    make_pair(result->GetValue(1, row).GetValue<idx_t>(), result->GetValue(2, row).GetValue<timestamp_t>());
+		}
+		vector<CacheFile> stale;
+		for (auto &file : files) {
+			auto entry = cached.find(file.path);
+			if (entry == cached.end() || entry->second.first != file.file_size || entry->second.second != file.mtime) {
+				stale.push_back(file);
+			}
+		}
+		if (!stale.empty()) {
+			RefreshFiles(connection, fs, stale, rows_table, files_table, scan_options);
+		}
+	}
+
+	// Scan of the cached rows of the files
+	Parser parser(context.GetParserOptions());
+	parser.ParseQuery("SELECT * FROM " + rows_table + " WHERE log_file IN (" + FileList(files) + ")");
+	auto select = unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+	return make_uniq<SubqueryRef>(std::move(select));
+}
+
+} // namespace duckdb
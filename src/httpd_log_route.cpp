@@ -0,0 +1,126 @@
+#include "httpd_log_route.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/value.hpp"
+
+namespace duckdb {
+
+// Hex strings shorter than this are kept (words like "cafe" or "add" are hex too)
+static constexpr idx_t MIN_HEX_SEGMENT_LENGTH = 8;
+
+vector<HttpdLogRouteRule> HttpdLogRoute::ParseRules(const Value &rules) {
+	vector<HttpdLogRouteRule> result;
+	for (auto &entry : MapValue::GetChildren(rules)) {
+		auto &key_value = StructValue::GetChildren(entry);
+		if (key_value[0].IsNull() || key_value[1].IsNull()) {
+			throw BinderException("route_rules cannot contain NULL");
+		}
+		HttpdLogRouteRule rule;
+		auto pattern = StringValue::Get(key_value[0]);
+		rule.pattern = make_shared_ptr<duckdb_re2::RE2>(pattern, duckdb_re2::RE2::Quiet);
+		if (!rule.pattern->ok()) {
+			throw BinderException("Invalid route_rules pattern '%s': %s", pattern, rule.pattern->error());
+		}
+		rule.rewrite = StringValue::Get(key_value[1]);
+		string error;
+		if (!rule.pattern->CheckRewriteString(rule.rewrite, &error)) {
+			throw BinderException("Invalid route_rules rewrite '%s' for '%s': %s", rule.rewrite, pattern, error);
+		}
+		result.push_back(std::move(rule));
+	}
+	return result;
+}
+
+static bool IsHexDigit(char c) {
+	return StringUtil::CharacterIsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static bool IsNumericSegment(const char *data, idx_t size) {
+	for (idx_t i = 0; i < size; i++) {
+		if (!StringUtil::CharacterIsDigit(data[i])) {
+			return false;
+		}
+	}
+	return size > 0;
+}
+
+// 8-4-4-4-12 hex digits
+static bool IsUuidSegment(const char *data, idx_t size) {
+	if (size != 36) {
+		return false;
+	}
+	for (idx_t i = 0; i < size; i++) {
+		bool dash = i == 8 || i == 13 || i == 18 || i == 23;
+		if (dash ? data[i] != '-' : !IsHexDigit(data[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Hashes and object ids: hex digits only, with at least one decimal digit
+static bool IsHexSegment(const char *data, idx_t size) {
+	if (size < MIN_HEX_SEGMENT_LENGTH) {
+		return false;
+	}
+	bool has_digit = false;
+	for (idx_t i = 0; i < size; i++) {
+		if (!IsHexDigit(data[i])) {
+			return false;
+		}
+		has_digit = has_digit || StringUtil::CharacterIsDigit(data[i]);
+	}
+	return has_digit;
+}
+
+string HttpdLogRoute::ReplaceSegments(const string &path) {
+	string result;
+	result.reserve(path.size());
+	idx_t start = 0;
+	while (start <= path.size()) {
+		auto end = path.find('/', start);
+		if (end == string::npos) {
+			end = path.size();
+		}
+		auto data = path.data() + start;
+		auto size = end - start;
+		if (IsNumericSegment(data, size)) {
+			result += "{id}";
+		} else if (IsUuidSegment(data, size)) {
+			result += "{uuid}";
+		} else if (IsHexSegment(data, size)) {
+			result += "{hex}";
+		} else {
+			result.append(data, size);
+		}
+		if (end == path.size()) {
+			break;
+		}
+		result += '/';
+		start = end + 1;
+	}
+	return result;
+}
+
+string HttpdLogRoute::Template(const vector<HttpdLogRouteRule> &rules, const string &path) {
+	for (auto &rule : rules) {
+		string route = path;
+		if (duckdb_re2::RE2::Replace(&route, *rule.pattern, rule.rewrite)) {
+			return route;
+		}
+	}
+	return ReplaceSegments(path);
+}
+
+const string &HttpdLogRouteCache::Get(const vector<HttpdLogRouteRule> &rules, const string &path) {
+	auto entry = routes.find(path);
+	if (entry != routes.end()) {
+		return entry->second;
+	}
+	if (routes.size() >= CACHE_SIZE) {
+		routes.clear();
+	}
+	return routes.emplace(path, HttpdLogRoute::Template(rules, path)).first->second;
+}
+
+} // namespace duckdb
@@ -0,0 +1,332 @@
+#include "httpd_log_sessions.hpp"
+#include "httpd_log_multi_file_info.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/multi_file/multi_file_reader.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/types/interval.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include <algorithm>
+
+namespace duckdb {
+
+// Columns identifying a visitor when key is not given (those the format produces)
+static const vector<string> DEFAULT_KEY_COLUMNS = {"client_host", "user_agent"};
+
+static int64_t PositiveMicros(const Value &value, const string &option) {
+	auto micros = Interval::GetMicro(IntervalValue::Get(value));
+	if (micros <= 0) {
+		throw BinderException("httpd_log_sessions: %s must be a positive interval", option);
+	}
+	return micros;
+}
+
+unique_ptr<FunctionData> HttpdLogSessions::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("httpd_log_sessions: path cannot be NULL");
+	}
+	auto bind_data = make_uniq<BindData>();
+	bind_data->path_pattern = input.inputs[0].GetValue<string>();
+	bind_data->gap_micros = 30 * Interval::MICROS_PER_MINUTE;
+	bind_data->out_of_order_micros = Interval::MICROS_PER_MINUTE;
+
+	// Same format options as read_httpd_log
+	HttpdLogBindData httpd_data;
+	bool has_key = false;
+	for (auto &param : input.named_parameters) {
+		if (param.second.IsNull()) {
+			throw BinderException("Cannot use NULL as argument to key %s", param.first);
+		}
+		auto loption = StringUtil::Lower(param.first);
+		if (loption == "gap") {
+			bind_data->gap_micros = PositiveMicros(param.second, loption);
+		} else if (loption == "out_of_order") {
+			bind_data->out_of_order_micros = PositiveMicros(param.second, loption);
+		} else if (loption == "key") {
+			has_key = true;
+			for (auto &column : ListValue::GetChildren(param.second)) {
+				if (column.IsNull()) {
+					throw BinderException("httpd_log_sessions: key cannot contain NULL");
+				}
+				bind_data->key_columns.push_back(StringValue::Get(column));
+			}
+			if (bind_data->key_columns.empty()) {
+				throw BinderException("httpd_log_sessions: key must name at least one column");
+			}
+		} else if (loption == "format_type" || loption == "format_str" || loption == "conf") {
+			if (loption == "format_type") {
+				httpd_data.format_type = StringValue::Get(param.second);
+			} else if (loption == "format_str") {
+				httpd_data.format_str = StringValue::Get(param.second);
+			} else {
+				httpd_data.conf = StringValue::Get(param.second);
+			}
+			bind_data->scan_options += ", " + loption + " := " + param.second.ToSQLString();
+		} else {
+			throw BinderException("httpd_log_sessions: unsupported parameter %s", param.first);
+		}
+	}
+
+	// Resolve the format to find the key, bytes and path columns (the glob is expanded only as far as needed)
+	auto multi_file_reader = MultiFileReader::Create(input.table_function);
+	auto file_list = multi_file_reader->CreateFileList(context, input.inputs[0]);
+	HttpdLogMultiFileInfo::BindFormat(context, httpd_data, *file_list);
+	if (!httpd_data.parsed_format.compiled_regex) {
+		throw BinderException("httpd_log_sessions: could not determine the log format, specify format_type, "
+		                      "format_str or conf");
+	}
+	vector<string> schema_names;
+	vector<LogicalType> schema_types;
+	HttpdLogFormatParser::GenerateSchema(httpd_data.parsed_format, schema_names, schema_types, false, false);
+	auto find_column = [&](const string &name) {
+		return NumericCast<idx_t>(std::find(schema_names.begin(), schema_names.end(), name) - schema_names.begin());
+	};
+	if (find_column("timestamp") == schema_names.size()) {
+		throw BinderException("httpd_log_sessions requires a log format with a timestamp (%t)");
+	}
+	if (!has_key) {
+		for (auto &column : DEFAULT_KEY_COLUMNS) {
+			if (find_column(column) < schema_names.size()) {
+				bind_data->key_columns.push_back(column);
+			}
+		}
+		if (bind_data->key_columns.empty()) {
+			throw BinderException("httpd_log_sessions: the log format has no client_host, specify key");
+		}
+	}
+	for (auto &column : bind_data->key_columns) {
+		auto column_idx = find_column(column);
+		if (column_idx == schema_names.size()) {
+			throw BinderException("httpd_log_sessions: column \"%s\" in key is not produced by the log format",
+			                      column);
+		}
+		bind_data->key_types.push_back(schema_types[column_idx]);
+	}
+	bind_data->has_bytes = find_column("bytes") < schema_names.size();
+	bind_data->has_path = find_column("path") < schema_names.size();
+
+	names = bind_data->key_columns;
+	return_types = bind_data->key_types;
+
+	names.emplace_back("session_start");
+	return_types.emplace_back(LogicalType::TIMESTAMP);
+
+	names.emplace_back("session_end");
+	return_types.emplace_back(LogicalType::TIMESTAMP);
+
+	names.emplace_back("hits");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	if (bind_data->has_bytes) {
+		names.emplace_back("total_bytes");
+		return_types.emplace_back(LogicalType::BIGINT);
+	}
+
+	if (bind_data->has_path) {
+		names.emplace_back("entry_path");
+		return_types.emplace_back(LogicalType::VARCHAR);
+
+		names.emplace_back("exit_path");
+		return_types.emplace_back(LogicalType::VARCHAR);
+	}
+
+	return std::move(bind_data);
+}
+
+unique_ptr<GlobalTableFunctionState> HttpdLogSessions::Init(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<BindData>();
+	auto state = make_uniq<GlobalState>();
+
+	// Lines of all files merged by timestamp (assume_sorted), only the columns the sessions need
+	vector<string> columns {"\"timestamp\""};
+	for (auto &column : bind_data.key_columns) {
+		columns.push_back(KeywordHelper::WriteOptionallyQuoted(column));
+	}
+	if (bind_data.has_bytes) {
+		columns.emplace_back("bytes");
+	}
+	if (bind_data.has_path) {
+		columns.emplace_back("path");
+	}
+	state->connection = make_uniq<Connection>(*context.db);
+	state->scan = state->connection->SendQuery("SELECT " + StringUtil::Join(columns, ", ") + " FROM read_httpd_log(" +
+	                                           KeywordHelper::WriteQuoted(bind_data.path_pattern, '\'') +
+	                                           ", assume_sorted := true" + bind_data.scan_options + ")");
+	if (state->scan->HasError()) {
+		state->scan->ThrowError("httpd_log_sessions: ");
+	}
+	return std::move(state);
+}
+
+size_t HttpdLogSessions::KeyHash::operator()(const vector<Value> &key) const {
+	hash_t result = 0;
+	for (auto &value : key) {
+		result = CombineHash(result, value.Hash());
+	}
+	return result;
+}
+
+bool HttpdLogSessions::KeyEquality::operator()(const vector<Value> &a, const vector<Value> &b) const {
+	for (idx_t i = 0; i < a.size(); i++) {
+		if (!Value::NotDistinctFrom(a[i], b[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void HttpdLogSessions::AddLine(const BindData &bind_data, GlobalState &state, const vector<Value> &key,
+                               timestamp_t timestamp, int64_t bytes, const string &path) {
+	if (timestamp > state.newest) {
+		state.newest = timestamp;
+	}
+	Session line;
+	line.start = line.end = timestamp;
+	line.hits = 1;
+	line.bytes = bytes;
+
+	auto entry = state.open_sessions.find(key);
+	if (entry != state.open_sessions.end()) {
+		auto &session = entry->second;
+		if (timestamp.value <= session.end.value + bind_data.gap_micros &&
+		    timestamp.value + bind_data.gap_micros >= session.start.value) {
+			state.open_by_end.erase(make_pair(session.end, session.id));
+			session.hits++;
+			session.bytes += bytes;
+			if (timestamp >= session.end) {
+				session.end = timestamp;
+				session.exit_path = path;
+			}
+			if (timestamp < session.start) {
+				session.start = timestamp;
+				session.entry_path = path;
+			}
+			state.open_by_end.emplace(make_pair(session.end, session.id), &session);
+			return;
+		}
+		if (timestamp < session.start) {
+			// Older than the open session by more than gap: a session of its own
+			line.id = state.next_session_id++;
+			line.key = key;
+			line.entry_path = line.exit_path = path;
+			state.closed_sessions.push_back(std::move(line));
+			return;
+		}
+		// The previous session of the visitor has ended
+		state.open_by_end.erase(make_pair(session.end, session.id));
+		state.closed_sessions.push_back(std::move(session));
+		state.open_sessions.erase(entry);
+	}
+
+	line.id = state.next_session_id++;
+	line.key = key;
+	line.entry_path = line.exit_path = path;
+	auto &session = state.open_sessions.emplace(key, std::move(line)).first->second;
+	state.open_by_end.emplace(make_pair(timestamp, session.id), &session);
+}
+
+void HttpdLogSessions::CloseExpiredSessions(const BindData &bind_data, GlobalState &state) {
+	if (state.open_by_end.empty()) {
+		return;
+	}
+	// A line can still extend a session only if it lags behind the newest line by less than out_of_order
+	auto threshold = state.newest.value - bind_data.out_of_order_micros - bind_data.gap_micros;
+	while (!state.open_by_end.empty() && state.open_by_end.begin()->first.first.value < threshold) {
+		auto entry = state.open_sessions.find(state.open_by_end.begin()->second->key);
+		state.closed_sessions.push_back(std::move(entry->second));
+		state.open_sessions.erase(entry);
+		state.open_by_end.erase(state.open_by_end.begin());
+	}
+}
+
+void HttpdLogSessions::Function(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<BindData>();
+	auto &state = data.global_state->Cast<GlobalState>();
+	auto key_count = bind_data.key_columns.size();
+
+	idx_t output_idx = 0;
+	while (output_idx < STANDARD_VECTOR_SIZE) {
+		if (!state.closed_sessions.empty()) {
+			auto &session = state.closed_sessions.front();
+			idx_t column = 0;
+			for (; column < key_count; column++) {
+				output.SetValue(column, output_idx, session.key[column]);
+			}
+			output.SetValue(column++, output_idx, Value::TIMESTAMP(session.start));
+			output.SetValue(column++, output_idx, Value::TIMESTAMP(session.end));
+			output.SetValue(column++, output_idx, Value::BIGINT(session.hits));
+			if (bind_data.has_bytes) {
+				output.SetValue(column++, output_idx, Value::BIGINT(session.bytes));
+			}
+			if (bind_data.has_path) {
+				output.SetValue(column++, output_idx, Value(session.entry_path));
+				output.SetValue(column++, output_idx, Value(session.exit_path));
+			}
+			state.closed_sessions.pop_front();
+			output_idx++;
+			continue;
+		}
+		if (state.scan_finished) {
+			if (state.open_by_end.empty()) {
+				break;
+			}
+			// End of the logs: every open session ends
+			for (auto &entry : state.open_by_end) {
+				state.closed_sessions.push_back(std::move(*entry.second));
+			}
+			state.open_by_end.clear();
+			state.open_sessions.clear();
+			continue;
+		}
+
+		auto chunk = state.scan->Fetch();
+		if (state.scan->HasError()) {
+			state.scan->ThrowError("httpd_log_sessions: ");
+		}
+		if (!chunk || chunk->size() == 0) {
+			state.scan_finished = true;
+			continue;
+		}
+		chunk->Flatten();
+		auto timestamps = FlatVector::GetData<timestamp_t>(chunk->data[0]);
+		auto &timestamp_validity = FlatVector::Validity(chunk->data[0]);
+		auto bytes_column = 1 + key_count;
+		auto path_column = bytes_column + (bind_data.has_bytes ? 1 : 0);
+		// Reused for every row: only a line that opens a session copies its key
+		vector<Value> key(key_count);
+		for (idx_t row = 0; row < chunk->size(); row++) {
+			if (!timestamp_validity.RowIsValid(row)) {
+				continue;
+			}
+			for (idx_t k = 0; k < key_count; k++) {
+				key[k] = chunk->GetValue(1 + k, row);
+			}
+			int64_t bytes = 0;
+			if (bind_data.has_bytes && FlatVector::Validity(chunk->data[bytes_column]).RowIsValid(row)) {
+				bytes = FlatVector::GetData<int64_t>(chunk->data[bytes_column])[row];
+			}
+			string path;
+			if (bind_data.has_path && FlatVector::Validity(chunk->data[path_column]).RowIsValid(row)) {
+				path = FlatVector::GetData<string_t>(chunk->data[path_column])[row].GetString();
+			}
+			AddLine(bind_data, state, key, timestamps[row], bytes, path);
+		}
+		CloseExpiredSessions(bind_data, state);
+	}
+	output.SetCardinality(output_idx);
+}
+
+void HttpdLogSessions::RegisterFunction(ExtensionLoader &loader) {
+	TableFunction func("httpd_log_sessions", {LogicalType::VARCHAR}, Function, Bind, Init);
+	func.named_parameters["gap"] = LogicalType::INTERVAL;
+	func.named_parameters["out_of_order"] = LogicalType::INTERVAL;
+	func.named_parameters["key"] = LogicalType::LIST(LogicalType::VARCHAR);
+	func.named_parameters["format_type"] = LogicalType::VARCHAR;
+	func.named_parameters["format_str"] = LogicalType::VARCHAR;
+	func.named_parameters["conf"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(func);
+}
+
+} // namespace duckdb
@@ -0,0 +1,356 @@
+#include "httpd_log_sketch.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/vector_operations/binary_executor.hpp"
+#include "duckdb/common/vector_operations/unary_executor.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/extension/extension_loader.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace duckdb {
+
+// Serialized sketches start with a tag byte
+static constexpr char HLL_TAG = 'H';
+static constexpr char DDSKETCH_TAG = 'D';
+
+//===--------------------------------------------------------------------===//
+// HttpdLogHll
+//===--------------------------------------------------------------------===//
+void HttpdLogHll::Add(hash_t hash) {
+	// First PRECISION bits select the register, the rest give the rank (position of the first 1 bit)
+	auto index = hash >> (64 - PRECISION);
+	auto remaining = hash << PRECISION;
+	uint8_t rank = 1;
+	while (rank <= 64 - PRECISION && !(remaining & (uint64_t(1) << 63))) {
+		rank++;
+		remaining <<= 1;
+	}
+	registers[index] = MaxValue(registers[index], rank);
+}
+
+void HttpdLogHll::Merge(const HttpdLogHll &other) {
+	for (idx_t i = 0; i < REGISTER_COUNT; i++) {
+		registers[i] = MaxValue(registers[i], other.registers[i]);
+	}
+}
+
+idx_t HttpdLogHll::Estimate() const {
+	auto m = static_cast<double>(REGISTER_COUNT);
+	double sum = 0;
+	idx_t zeros = 0;
+	for (auto rank : registers) {
+		sum += std::ldexp(1.0, -rank);
+		zeros += rank == 0;
+	}
+	auto alpha = 0.7213 / (1.0 + 1.079 / m);
+	auto estimate = alpha * m * m / sum;
+	if (estimate <= 2.5 * m && zeros > 0) {
+		// Small cardinalities: linear counting of the empty registers
+		estimate = m * std::log(m / static_cast<double>(zeros));
+	}
+	return static_cast<idx_t>(std::llround(estimate));
+}
+
+string HttpdLogHll::Serialize() const {
+	string result;
+	result += HLL_TAG;
+	result += static_cast<char>(PRECISION);
+	result.append(reinterpret_cast<const char *>(registers.data()), registers.size());
+	return result;
+}
+
+HttpdLogHll HttpdLogHll::Deserialize(const string_t &blob) {
+	auto data = blob.GetData();
+	if (blob.GetSize() != 2 + REGISTER_COUNT || data[0] != HLL_TAG || data[1] != static_cast<char>(PRECISION)) {
+		throw InvalidInputException("httpd_log_hll: not a sketch created by httpd_log_hll");
+	}
+	HttpdLogHll result;
+	memcpy(result.registers.data(), data + 2, REGISTER_COUNT);
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// HttpdLogDDSketch
+//===--------------------------------------------------------------------===//
+static const double DDSKETCH_GAMMA =
+    (1.0 + HttpdLogDDSketch::RELATIVE_ACCURACY) / (1.0 - HttpdLogDDSketch::RELATIVE_ACCURACY);
+static const double DDSKETCH_LOG_GAMMA = std::log(DDSKETCH_GAMMA);
+
+int32_t HttpdLogDDSketch::BinIndex(double magnitude) {
+	return static_cast<int32_t>(std::ceil(std::log(magnitude) / DDSKETCH_LOG_GAMMA));
+}
+
+double HttpdLogDDSketch::BinValue(int32_t index) {
+	// Midpoint (in relative terms) of (gamma^(index-1), gamma^index]
+	return 2.0 * std::pow(DDSKETCH_GAMMA, index) / (DDSKETCH_GAMMA + 1.0);
+}
+
+void HttpdLogDDSketch::Collapse(map<int32_t, uint64_t> &bins) {
+	// The smallest magnitudes lose their accuracy first
+	while (bins.size() > MAX_BINS) {
+		auto lowest = bins.begin();
+		auto next = std::next(lowest);
+		next->second += lowest->second;
+		bins.erase(lowest);
+	}
+}
+
+void HttpdLogDDSketch::Add(double value) {
+	count++;
+	if (std::fabs(value) < MIN_MAGNITUDE) {
+		zero_count++;
+		return;
+	}
+	auto &bins = value > 0 ? positive : negative;
+	bins[BinIndex(std::fabs(value))]++;
+	Collapse(bins);
+}
+
+void HttpdLogDDSketch::Merge(const HttpdLogDDSketch &other) {
+	for (auto &bin : other.positive) {
+		positive[bin.first] += bin.second;
+	}
+	for (auto &bin : other.negative) {
+		negative[bin.first] += bin.second;
+	}
+	Collapse(positive);
+	Collapse(negative);
+	zero_count += other.zero_count;
+	count += other.count;
+}
+
+double HttpdLogDDSketch::Quantile(double q) const {
+	if (q < 0 || q > 1) {
+		throw InvalidInputException("httpd_log_ddsketch_quantile: quantile must be between 0 and 1, got %f", q);
+	}
+	if (count == 0) {
+		throw InvalidInputException("httpd_log_ddsketch_quantile: the sketch is empty");
+	}
+	// Walk the bins in value order until more than rank values are passed
+	auto rank = q * static_cast<double>(count - 1);
+	double passed = 0;
+	for (auto bin = negative.rbegin(); bin != negative.rend(); ++bin) {
+		passed += static_cast<double>(bin->second);
+		if (passed > rank) {
+			return -BinValue(bin->first);
+		}
+	}
+	passed += static_cast<double>(zero_count);
+	if (passed > rank) {
+		return 0;
+	}
+	for (auto &bin : positive) {
+		passed += static_cast<double>(bin.second);
+		if (passed > rank) {
+			return BinValue(bin.first);
+		}
+	}
+	return BinValue(positive.rbegin()->first);
+}
+
+template <class T>
+static void AppendValue(string &result, T value) {
+	result.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Reads the fields of a serialized sketch, rejecting truncated input
+struct SketchReader {
+	const char *data;
+	idx_t size;
+	idx_t pos = 0;
+
+	template <class T>
+	T Read() {
+		if (pos + sizeof(T) > size) {
+			throw InvalidInputException("httpd_log_ddsketch: not a sketch created by httpd_log_ddsketch");
+		}
+		T value;
+		memcpy(&value, data + pos, sizeof(T));
+		pos += sizeof(T);
+		return value;
+	}
+};
+
+static void AppendBins(string &result, const map<int32_t, uint64_t> &bins) {
+	AppendValue<uint32_t>(result, NumericCast<uint32_t>(bins.size()));
+	for (auto &bin : bins) {
+		AppendValue<int32_t>(result, bin.first);
+		AppendValue<uint64_t>(result, bin.second);
+	}
+}
+
+static uint64_t ReadBins(SketchReader &reader, map<int32_t, uint64_t> &bins) {
+	uint64_t total = 0;
+	auto bin_count = reader.Read<uint32_t>();
+	for (uint32_t i = 0; i < bin_count; i++) {
+		auto index = reader.Read<int32_t>();
+		auto bin_total = reader.Read<uint64_t>();
+		bins[index] += bin_total;
+		total += bin_total;
+	}
+	return total;
+}
+
+string HttpdLogDDSketch::Serialize() const {
+	string result;
+	result += DDSKETCH_TAG;
+	AppendValue<uint64_t>(result, zero_count);
+	AppendBins(result, negative);
+	AppendBins(result, positive);
+	return result;
+}
+
+HttpdLogDDSketch HttpdLogDDSketch::Deserialize(const string_t &blob) {
+	SketchReader reader {blob.GetData(), blob.GetSize()};
+	if (reader.Read<char>() != DDSKETCH_TAG) {
+		throw InvalidInputException("httpd_log_ddsketch: not a sketch created by httpd_log_ddsketch");
+	}
+	HttpdLogDDSketch result;
+	result.zero_count = reader.Read<uint64_t>();
+	result.count = result.zero_count;
+	result.count += ReadBins(reader, result.negative);
+	result.count += ReadBins(reader, result.positive);
+	if (reader.pos != reader.size) {
+		throw InvalidInputException("httpd_log_ddsketch: not a sketch created by httpd_log_ddsketch");
+	}
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// Aggregates
+// Each thread aggregates into its own state; states are combined at the end, as for any DuckDB aggregate
+//===--------------------------------------------------------------------===//
+template <class SKETCH>
+struct SketchState {
+	using SKETCH_TYPE = SKETCH;
+	SKETCH *sketch;
+};
+
+struct SketchOperationBase {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.sketch = nullptr;
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
+	                              idx_t count) {
+		for (idx_t i = 0; i < count; i++) {
+			OP::template Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
+		}
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &) {
+		if (!source.sketch) {
+			return;
+		}
+		if (!target.sketch) {
+			target.sketch = new typename STATE::SKETCH_TYPE(*source.sketch);
+			return;
+		}
+		target.sketch->Merge(*source.sketch);
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+		if (!state.sketch) {
+			finalize_data.ReturnNull();
+			return;
+		}
+		target = StringVector::AddStringOrBlob(finalize_data.result, state.sketch->Serialize());
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &) {
+		delete state.sketch;
+		state.sketch = nullptr;
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+// httpd_log_hll(VARCHAR)
+struct HllAddOperation : public SketchOperationBase {
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &) {
+		if (!state.sketch) {
+			state.sketch = new HttpdLogHll();
+		}
+		state.sketch->Add(Hash(input.GetData(), input.GetSize()));
+	}
+};
+
+// httpd_log_ddsketch(DOUBLE)
+struct DDSketchAddOperation : public SketchOperationBase {
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &) {
+		if (!std::isfinite(input)) {
+			return;
+		}
+		if (!state.sketch) {
+			state.sketch = new HttpdLogDDSketch();
+		}
+		state.sketch->Add(input);
+	}
+};
+
+// httpd_log_hll_merge(BLOB), httpd_log_ddsketch_merge(BLOB)
+struct SketchMergeOperation : public SketchOperationBase {
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &) {
+		auto sketch = STATE::SKETCH_TYPE::Deserialize(input);
+		if (!state.sketch) {
+			state.sketch = new typename STATE::SKETCH_TYPE(std::move(sketch));
+			return;
+		}
+		state.sketch->Merge(sketch);
+	}
+};
+
+template <class STATE, class INPUT_TYPE, class OP>
+static AggregateFunction SketchAggregate(const string &name, const LogicalType &input_type) {
+	auto function =
+	    AggregateFunction::UnaryAggregateDestructor<STATE, INPUT_TYPE, string_t, OP>(input_type, LogicalType::BLOB);
+	function.name = name;
+	return function;
+}
+
+//===--------------------------------------------------------------------===//
+// Scalar functions
+//===--------------------------------------------------------------------===//
+static void HllEstimateFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	UnaryExecutor::Execute<string_t, int64_t>(args.data[0], result, args.size(), [](string_t blob) {
+		return NumericCast<int64_t>(HttpdLogHll::Deserialize(blob).Estimate());
+	});
+}
+
+static void DDSketchQuantileFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	BinaryExecutor::Execute<string_t, double, double>(
+	    args.data[0], args.data[1], result, args.size(),
+	    [](string_t blob, double q) { return HttpdLogDDSketch::Deserialize(blob).Quantile(q); });
+}
+
+void HttpdLogSketch::RegisterFunctions(ExtensionLoader &loader) {
+	using HllState = SketchState<HttpdLogHll>;
+	using DDSketchState = SketchState<HttpdLogDDSketch>;
+	loader.RegisterFunction(
+	    SketchAggregate<HllState, string_t, HllAddOperation>("httpd_log_hll", LogicalType::VARCHAR));
+	loader.RegisterFunction(
+	    SketchAggregate<HllState, string_t, SketchMergeOperation>("httpd_log_hll_merge", LogicalType::BLOB));
+	loader.RegisterFunction(
+	    SketchAggregate<DDSketchState, double, DDSketchAddOperation>("httpd_log_ddsketch", LogicalType::DOUBLE));
+	loader.RegisterFunction(
+	    SketchAggregate<DDSketchState, string_t, SketchMergeOperation>("httpd_log_ddsketch_merge", LogicalType::BLOB));
+
+	loader.RegisterFunction(
+	    ScalarFunction("httpd_log_hll_estimate", {LogicalType::BLOB}, LogicalType::BIGINT, HllEstimateFunction));
+	loader.RegisterFunction(ScalarFunction("httpd_log_ddsketch_quantile", {LogicalType::BLOB, LogicalType::DOUBLE},
+	                                       LogicalType::DOUBLE, DDSketchQuantileFunction));
+}
+
+} // namespace duckdb
@@ -0,0 +1,120 @@
+#include "httpd_log_summary.hpp"
+#include "httpd_log_multi_file_info.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/multi_file/multi_file_reader.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/parser/tableref/subqueryref.hpp"
+#include <algorithm>
+
+namespace duckdb {
+
+// Status classes counted per bucket (status_2xx ... status_5xx)
+static constexpr int32_t STATUS_CLASSES[] = {2, 3, 4, 5};
+
+unique_ptr<TableRef> HttpdLogSummary::BindReplace(ClientContext &context, TableFunctionBindInput &input) {
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("httpd_log_summary: path cannot be NULL");
+	}
+	auto path_pattern = input.inputs[0].GetValue<string>();
+
+	// Same format and file selection options as read_httpd_log
+	HttpdLogBindData httpd_data;
+	auto bucket = Interval::FromMicro(Interval::MICROS_PER_MINUTE);
+	vector<string> group_columns;
+	string scan_options;
+	for (auto &param : input.named_parameters) {
+		if (param.second.IsNull()) {
+			throw BinderException("Cannot use NULL as argument to key %s", param.first);
+		}
+		auto loption = StringUtil::Lower(param.first);
+		if (loption == "bucket") {
+			bucket = IntervalValue::Get(param.second);
+			if (bucket.months < 0 || bucket.days < 0 || bucket.micros < 0 ||
+			    (bucket.months == 0 && bucket.days == 0 && bucket.micros == 0)) {
+				throw BinderException("httpd_log_summary: bucket must be a positive interval");
+			}
+			continue;
+		}
+		if (loption == "by") {
+			for (auto &column : ListValue::GetChildren(param.second)) {
+				if (column.IsNull()) {
+					throw BinderException("httpd_log_summary: by cannot contain NULL");
+				}
+				group_columns.push_back(StringValue::Get(column));
+			}
+			continue;
+		}
+		if (loption == "format_type") {
+			httpd_data.format_type = StringValue::Get(param.second);
+		} else if (loption == "format_str") {
+			httpd_data.format_str = StringValue::Get(param.second);
+		} else if (loption == "conf") {
+			httpd_data.conf = StringValue::Get(param.second);
+		} else {
+			throw BinderException("httpd_log_summary: unsupported parameter %s", param.first);
+		}
+		scan_options += ", " + loption + " := " + param.second.ToSQLString();
+	}
+
+	// Resolve the format to check the columns the summary needs (the glob is expanded only as far as needed)
+	auto multi_file_reader = MultiFileReader::Create(input.table_function);
+	auto file_list = multi_file_reader->CreateFileList(context, input.inputs[0]);
+	HttpdLogMultiFileInfo::BindFormat(context, httpd_data, *file_list);
+	if (!httpd_data.parsed_format.compiled_regex) {
+		throw BinderException("httpd_log_summary: could not determine the log format, specify format_type, "
+		                      "format_str or conf");
+	}
+	vector<string> names;
+	vector<LogicalType> types;
+	HttpdLogFormatParser::GenerateSchema(httpd_data.parsed_format, names, types, false, false);
+	auto has_column = [&](const string &name) {
+		return std::find(names.begin(), names.end(), name) != names.end();
+	};
+	if (!has_column("timestamp")) {
+		throw BinderException("httpd_log_summary requires a log format with a timestamp (%t)");
+	}
+
+	// SELECT time_bucket(...) AS bucket, <by>, COUNT(*) AS requests, ... FROM read_httpd_log(...) GROUP BY ALL
+	vector<string> select_list;
+	select_list.push_back("time_bucket(CAST(" + KeywordHelper::WriteQuoted(Value::INTERVAL(bucket).ToString(), '\'') +
+	                      " AS INTERVAL), \"timestamp\") AS bucket");
+	for (auto &column : group_columns) {
+		if (!has_column(column)) {
+			throw BinderException("httpd_log_summary: column \"%s\" in by is not produced by the log format", column);
+		}
+		select_list.push_back(KeywordHelper::WriteOptionallyQuoted(column));
+	}
+	select_list.push_back("COUNT(*) AS requests");
+	if (has_column("bytes")) {
+		select_list.push_back("CAST(SUM(bytes) AS BIGINT) AS total_bytes");
+	}
+	if (has_column("status")) {
+		for (auto status_class : STATUS_CLASSES) {
+			select_list.push_back(StringUtil::Format("COUNT(*) FILTER (status BETWEEN %d00 AND %d99) AS status_%dxx",
+			                                         status_class, status_class, status_class));
+		}
+	}
+
+	Parser parser(context.GetParserOptions());
+	parser.ParseQuery("SELECT " + StringUtil::Join(select_list, ", ") + " FROM read_httpd_log(" +
+	                  KeywordHelper::WriteQuoted(path_pattern, '\'') + scan_options + ") GROUP BY ALL ORDER BY ALL");
+	auto select = unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+	return make_uniq<SubqueryRef>(std::move(select));
+}
+
+void HttpdLogSummary::RegisterFunction(ExtensionLoader &loader) {
+	TableFunction func("httpd_log_summary", {LogicalType::VARCHAR}, nullptr, nullptr);
+	func.bind_replace = BindReplace;
+	func.named_parameters["bucket"] = LogicalType::INTERVAL;
+	func.named_parameters["by"] = LogicalType::LIST(LogicalType::VARCHAR);
+	func.named_parameters["format_type"] = LogicalType::VARCHAR;
+	func.named_parameters["format_str"] = LogicalType::VARCHAR;
+	func.named_parameters["conf"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(func);
+}
+
+} // namespace duckdb
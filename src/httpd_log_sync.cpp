@@ -0,0 +1,157 @@
+#include "httpd_log_sync.hpp"
+#include "httpd_log_checkpoint.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_search_path.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/client_data.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+
+namespace duckdb {
+
+static unique_ptr<MaterializedQueryResult> RunQuery(Connection &connection, const string &query) {
+	auto result = connection.Query(query);
+	if (result->HasError()) {
+		result->ThrowError("httpd_log_sync: ");
+	}
+	return result;
+}
+
+// Fully qualified name of a table as the calling connection sees it (search path, USE): the sync runs in a
+// connection of its own, which would resolve the name against the database defaults
+static string ResolveTableName(ClientContext &context, const string &table_name) {
+	auto qualified = QualifiedName::Parse(table_name);
+	auto entry = Catalog::GetEntry<TableCatalogEntry>(context, qualified.catalog, qualified.schema, qualified.name,
+	                                                  OnEntryNotFound::RETURN_NULL);
+	if (entry) {
+		if (entry->ParentCatalog().IsTemporaryCatalog()) {
+			throw BinderException("httpd_log_sync: %s is a temporary table, which the sync cannot write to",
+			                      table_name);
+		}
+		qualified.catalog = entry->ParentCatalog().GetName();
+		qualified.schema = entry->ParentSchema().name;
+	} else {
+		// Created by the sync: in the calling connection's default schema unless qualified
+		auto default_entry = ClientData::Get(context).catalog_search_path->GetDefault();
+		if (qualified.catalog.empty()) {
+			qualified.catalog = default_entry.catalog.empty() ? DatabaseManager::GetDefaultDatabase(context)
+			                                                  : default_entry.catalog;
+		}
+		if (qualified.schema.empty()) {
+			qualified.schema = default_entry.schema.empty() ? DEFAULT_SCHEMA : default_entry.schema;
+		}
+	}
+	return KeywordHelper::WriteOptionallyQuoted(qualified.catalog) + "." +
+	       KeywordHelper::WriteOptionallyQuoted(qualified.schema) + "." +
+	       KeywordHelper::WriteOptionallyQuoted(qualified.name);
+}
+
+unique_ptr<FunctionData> HttpdLogSync::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                            vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs[0].IsNull() || input.inputs[1].IsNull()) {
+		throw BinderException("httpd_log_sync: table and path cannot be NULL");
+	}
+	// The rows and checkpoints are committed by the sync itself: a surrounding transaction could not undo them
+	if (!context.transaction.IsAutoCommit()) {
+		throw BinderException("httpd_log_sync cannot run inside an explicit transaction, it commits on its own");
+	}
+	auto bind_data = make_uniq<BindData>();
+	bind_data->table_name = input.inputs[0].GetValue<string>();
+	bind_data->path_pattern = input.inputs[1].GetValue<string>();
+	if (bind_data->table_name.empty()) {
+		throw BinderException("httpd_log_sync: table must be a table name");
+	}
+	bind_data->state_table = bind_data->table_name + "_sync_state";
+
+	// Same format options as read_httpd_log
+	for (auto &param : input.named_parameters) {
+		if (param.second.IsNull()) {
+			throw BinderException("Cannot use NULL as argument to key %s", param.first);
+		}
+		auto loption = StringUtil::Lower(param.first);
+		if (loption == "state_table") {
+			bind_data->state_table = StringValue::Get(param.second);
+			if (bind_data->state_table.empty()) {
+				throw BinderException("httpd_log_sync: state_table must be a table name");
+			}
+		} else if (loption == "format_type" || loption == "format_str" || loption == "conf") {
+			bind_data->format_options +=
+			    ", " + loption + " := " + KeywordHelper::WriteQuoted(StringValue::Get(param.second), '\'');
+		}
+	}
+
+	bind_data->table_name = ResolveTableName(context, bind_data->table_name);
+	bind_data->state_table = ResolveTableName(context, bind_data->state_table);
+
+	names.emplace_back("files_scanned");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	names.emplace_back("rows_inserted");
+	return_types.emplace_back(LogicalType::BIGINT);
+
+	return std::move(bind_data);
+}
+
+unique_ptr<GlobalTableFunctionState> HttpdLogSync::Init(ClientContext &context, TableFunctionInitInput &input) {
+	return make_uniq<GlobalState>();
+}
+
+void HttpdLogSync::Function(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<BindData>();
+	auto &state = data.global_state->Cast<GlobalState>();
+	if (state.done) {
+		return;
+	}
+	state.done = true;
+
+	auto table_name = HttpdLogCheckpointStore::QuoteTableName(bind_data.table_name);
+	auto state_table = HttpdLogCheckpointStore::QuoteTableName(bind_data.state_table);
+	auto scan_arguments = KeywordHelper::WriteQuoted(bind_data.path_pattern, '\'') + bind_data.format_options;
+
+	// The ingestion runs in its own connection and transaction
+	Connection connection(*context.db);
+
+	// Checkpoints of the scan are collected instead of committed on their own, and written with the rows
+	auto pending = make_shared_ptr<HttpdLogPendingCheckpoints>();
+	connection.context->registered_state->Insert(HttpdLogPendingCheckpoints::KEY, pending);
+
+	int64_t rows_inserted;
+	connection.BeginTransaction();
+	try {
+		// Created in the transaction too: a failed first sync leaves no empty tables behind
+		HttpdLogCheckpointStore::CreateTable(connection, state_table);
+		RunQuery(connection, "CREATE TABLE IF NOT EXISTS " + table_name + " AS SELECT * FROM read_httpd_log(" +
+		                         scan_arguments + ") LIMIT 0");
+		auto inserted = RunQuery(connection, "INSERT INTO " + table_name + " SELECT * FROM read_httpd_log(" +
+		                                         scan_arguments + ", checkpoint_table := " +
+		                                         KeywordHelper::WriteQuoted(bind_data.state_table, '\'') + ")");
+		rows_inserted = inserted->GetValue(0, 0).GetValue<int64_t>();
+		HttpdLogCheckpointStore::WriteCheckpoints(connection, state_table, pending->checkpoints);
+		connection.Commit();
+	} catch (...) {
+		if (connection.HasActiveTransaction()) {
+			connection.Rollback();
+		}
+		throw;
+	}
+
+	FlatVector::GetData<int64_t>(output.data[0])[0] = NumericCast<int64_t>(pending->files_planned);
+	FlatVector::GetData<int64_t>(output.data[1])[0] = rows_inserted;
+	output.SetCardinality(1);
+}
+
+void HttpdLogSync::RegisterFunction(ExtensionLoader &loader) {
+	TableFunction func("httpd_log_sync", {LogicalType::VARCHAR, LogicalType::VARCHAR}, Function, Bind, Init);
+	func.named_parameters["format_type"] = LogicalType::VARCHAR;
+	func.named_parameters["format_str"] = LogicalType::VARCHAR;
+	func.named_parameters["conf"] = LogicalType::VARCHAR;
+	func.named_parameters["state_table"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(func);
+}
+
+} // namespace duckdb
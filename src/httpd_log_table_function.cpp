@@ -1,5 +1,6 @@
 #include "httpd_log_table_function.hpp"
 #include "httpd_log_multi_file_info.hpp"
+#include "httpd_log_result_cache.hpp"
 #include "duckdb/function/table_function.hpp"
 #include "duckdb/common/file_system.hpp"
 #include "duckdb/common/multi_file/multi_file_function.hpp"
@@ -897,6 +898,31 @@ void HttpdLogTableFunction::RegisterFunction(ExtensionLoader &loader) {
 	table_function.named_parameters["format_str"] = LogicalType::VARCHAR;
 	table_function.named_parameters["conf"] = LogicalType::VARCHAR;
 	table_function.named_parameters["raw"] = LogicalType::BOOLEAN;
+	table_function.named_parameters["count_mode"] = LogicalType::VARCHAR;
+	table_function.named_parameters["reverse"] = LogicalType::BOOLEAN;
+	table_function.named_parameters["sample"] = LogicalType::DOUBLE;
+	table_function.named_parameters["sample_seed"] = LogicalType::BIGINT;
+	table_function.named_parameters["open_ahead"] = LogicalType::BIGINT;
+	table_function.named_parameters["cache_mode"] = LogicalType::VARCHAR;
+	table_function.named_parameters["assume_sorted"] = LogicalType::BOOLEAN;
+	table_function.named_parameters["checkpoint_table"] = LogicalType::VARCHAR;
+	table_function.named_parameters["skip_duplicates"] = LogicalType::VARCHAR;
+	table_function.named_parameters["filename_time_pattern"] = LogicalType::VARCHAR;
+	table_function.named_parameters["route_rules"] = LogicalType::MAP(LogicalType::VARCHAR, LogicalType::VARCHAR);
+	table_function.named_parameters["cache_dir"] = LogicalType::VARCHAR;
+
+	// cache_dir: the scan is replaced by a scan of the cached rows
+	table_function.bind_replace = HttpdLogResultCache::BindReplace;
+
+	// filename_time_pattern: files outside the timestamp filters are pruned before the scan
+	table_function.pushdown_complex_filter = HttpdLogMultiFileInfo::PushdownComplexFilter;
+
+	// Partition information for log_file (partitioned aggregation over GROUP BY log_file)
+	table_function.get_partition_info = HttpdLogMultiFileInfo::GetPartitionInfo;
+	table_function.get_partition_data = HttpdLogMultiFileInfo::GetPartitionData;
+
+	// EXPLAIN ANALYZE: files opened ahead (open_ahead)
+	table_function.dynamic_to_string = HttpdLogMultiFileInfo::DynamicToString;
 
 	// Register the function
 	loader.RegisterFunction(static_cast<TableFunction>(table_function));
@@ -0,0 +1,264 @@
+#include "httpd_log_time_range.hpp"
+#include "httpd_log_file_reader.hpp"
+#include "httpd_log_buffered_reader.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/multi_file/multi_file_list.hpp"
+#include "duckdb/main/client_context.hpp"
+#include <deque>
+
+namespace duckdb {
+
+// Bytes of text examined at each end of a file; the lines in these windows absorb
+// out-of-order entries (Apache logs the request start time but writes the line at completion)
+static constexpr idx_t EDGE_WINDOW_SIZE = 65536; // 64KB
+// Upper bound when a window contains no parseable line (e.g. a long run of garbage at the end)
+static constexpr idx_t MAX_EDGE_WINDOW_SIZE = 8388608; // 8MB
+
+void HttpdLogTimeRange::TimeRange::Update(timestamp_t ts) {
+	if (!has_value) {
+		min_ts = ts;
+		max_ts = ts;
+		has_value = true;
+		return;
+	}
+	if (ts < min_ts) {
+		min_ts = ts;
+	}
+	if (ts > max_ts) {
+		max_ts = ts;
+	}
+}
+
+void HttpdLogTimeRange::TimeRange::Merge(const TimeRange &other) {
+	if (other.has_value) {
+		Update(other.min_ts);
+		Update(other.max_ts);
+	}
+}
+
+// Parse a single line and add its timestamp to the range
+static void UpdateRangeFromLine(const string &line, const ParsedFormat &parsed_format,
+                                HttpdLogTimeRange::TimeRange &range) {
+	if (line.empty()) {
+		return;
+	}
+	auto values = HttpdLogFormatParser::ParseLogLine(line, parsed_format);
+	if (values.empty()) {
+		return;
+	}
+	timestamp_t ts;
+	if (HttpdLogFileReader::ExtractTimestamp(parsed_format, values, ts)) {
+		range.Update(ts);
+	}
+}
+
+// Parse all complete lines in a window of the file
+// skip_first: the window starts in the middle of a line; skip_last: the window ends in the middle of a line
+static void UpdateRangeFromWindow(const char *data, idx_t size, bool skip_first, bool skip_last,
+                                  const ParsedFormat &parsed_format, HttpdLogTimeRange::TimeRange &range) {
+	idx_t pos = 0;
+	if (skip_first) {
+		while (pos < size && data[pos] != '\n') {
+			pos++;
+		}
+		pos++;
+	}
+
+	string line;
+	while (pos < size) {
+		idx_t end = pos;
+		while (end < size && data[end] != '\n') {
+			end++;
+		}
+		if (end == size && skip_last) {
+			break;
+		}
+		line.assign(data + pos, end - pos);
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		UpdateRangeFromLine(line, parsed_format, range);
+		pos = end + 1;
+	}
+}
+
+// Compressed or non-seekable input: stream through without parsing, keeping only the edge lines
+static HttpdLogTimeRange::TimeRange ScanStreamEdges(FileSystem &fs, const string &path,
+                                                    const ParsedFormat &parsed_format) {
+	HttpdLogTimeRange::TimeRange range;
+	HttpdLogBufferedReader reader(fs, path);
+
+	string line;
+	idx_t head_bytes = 0;
+	std::deque<string> tail_lines;
+	idx_t tail_bytes = 0;
+
+	while (reader.ReadLine(line)) {
+		if (head_bytes < EDGE_WINDOW_SIZE) {
+			head_bytes += line.size() + 1;
+			UpdateRangeFromLine(line, parsed_format, range);
+			continue;
+		}
+		tail_bytes += line.size() + 1;
+		tail_lines.push_back(std::move(line));
+		while (tail_bytes > EDGE_WINDOW_SIZE && tail_lines.size() > 1) {
+			tail_bytes -= tail_lines.front().size() + 1;
+			tail_lines.pop_front();
+		}
+	}
+
+	for (const auto &tail_line : tail_lines) {
+		UpdateRangeFromLine(tail_line, parsed_format, range);
+	}
+	return range;
+}
+
+HttpdLogTimeRange::TimeRange HttpdLogTimeRange::ScanFileEdges(FileSystem &fs, const string &path,
+                                                              const ParsedFormat &parsed_format) {
+	if (HttpdLogBufferedReader::IsCompressedPath(path)) {
+		return ScanStreamEdges(fs, path, parsed_format);
+	}
+
+	auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+	if (!handle->CanSeek()) {
+		handle.reset();
+		return ScanStreamEdges(fs, path, parsed_format);
+	}
+
+	TimeRange range;
+	idx_t file_size = handle->GetFileSize();
+	if (file_size == 0) {
+		return range;
+	}
+
+	auto buffer = make_unsafe_uniq_array_uninitialized<char>(MinValue<idx_t>(file_size, MAX_EDGE_WINDOW_SIZE));
+
+	// Head: first lines of the file, widening the window until a line parses
+	TimeRange head;
+	idx_t head_end = 0;
+	for (idx_t window = EDGE_WINDOW_SIZE; !head.has_value && head_end < file_size && window <= MAX_EDGE_WINDOW_SIZE;
+	     window *= 2) {
+		head_end = MinValue<idx_t>(window, file_size);
+		handle->Read(buffer.get(), head_end, 0);
+		UpdateRangeFromWindow(buffer.get(), head_end, false, head_end < file_size, parsed_format, head);
+	}
+	range.Merge(head);
+	if (head_end == file_size) {
+		// The whole file fit into the head window
+		return range;
+	}
+
+	// Tail: last lines of the file, read backwards from EOF (overlap with the head window is harmless)
+	TimeRange tail;
+	for (idx_t window = EDGE_WINDOW_SIZE; window <= MAX_EDGE_WINDOW_SIZE; window *= 2) {
+		idx_t tail_start = file_size > window ? file_size - window : 0;
+		idx_t tail_size = file_size - tail_start;
+		handle->Read(buffer.get(), tail_size, tail_start);
+		UpdateRangeFromWindow(buffer.get(), tail_size, tail_start > 0, false, parsed_format, tail);
+		if (tail.has_value || tail_start == 0) {
+			break;
+		}
+	}
+	range.Merge(tail);
+	return range;
+}
+
+unique_ptr<FunctionData> HttpdLogTimeRange::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+	auto &fs = FileSystem::GetFileSystem(context);
+	auto path_pattern = input.inputs[0].GetValue<string>();
+
+	auto bind_data = make_uniq<BindData>();
+	bind_data->files = fs.GlobFiles(path_pattern, context, FileGlobOptions::DISALLOW_EMPTY);
+
+	// Same format options as read_httpd_log
+	auto &httpd_data = bind_data->httpd_data;
+	for (auto &param : input.named_parameters) {
+		if (param.second.IsNull()) {
+			throw BinderException("Cannot use NULL as argument to key %s", param.first);
+		}
+		auto loption = StringUtil::Lower(param.first);
+		if (loption == "format_type") {
+			httpd_data.format_type = StringValue::Get(param.second);
+		} else if (loption == "format_str") {
+			httpd_data.format_str = StringValue::Get(param.second);
+		} else if (loption == "conf") {
+			httpd_data.conf = StringValue::Get(param.second);
+		}
+	}
+
+	SimpleMultiFileList file_list(bind_data->files);
+	HttpdLogMultiFileInfo::BindFormat(context, httpd_data, file_list);
+	if (!httpd_data.parsed_format.compiled_regex) {
+		throw BinderException("httpd_log_time_range: could not determine the log format, specify format_type, "
+		                      "format_str or conf");
+	}
+
+	names.emplace_back("log_file");
+	return_types.emplace_back(LogicalType::VARCHAR);
+
+	names.emplace_back("min_timestamp");
+	return_types.emplace_back(LogicalType::TIMESTAMP);
+
+	names.emplace_back("max_timestamp");
+	return_types.emplace_back(LogicalType::TIMESTAMP);
+
+	return std::move(bind_data);
+}
+
+unique_ptr<GlobalTableFunctionState> HttpdLogTimeRange::Init(ClientContext &context, TableFunctionInitInput &input) {
+	return make_uniq<GlobalState>();
+}
+
+void HttpdLogTimeRange::Function(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<BindData>();
+	auto &state = data.global_state->Cast<GlobalState>();
+	auto &fs = FileSystem::GetFileSystem(context);
+
+	idx_t output_idx = 0;
+	const idx_t BATCH_SIZE = STANDARD_VECTOR_SIZE;
+
+	auto write_range = [&](const TimeRange &range) {
+		if (range.has_value) {
+			FlatVector::GetData<timestamp_t>(output.data[1])[output_idx] = range.min_ts;
+			FlatVector::GetData<timestamp_t>(output.data[2])[output_idx] = range.max_ts;
+		} else {
+			FlatVector::SetNull(output.data[1], output_idx, true);
+			FlatVector::SetNull(output.data[2], output_idx, true);
+		}
+	};
+
+	// One row per file
+	while (output_idx < BATCH_SIZE && state.current_idx < bind_data.files.size()) {
+		const auto &path = bind_data.files[state.current_idx].path;
+		auto range = ScanFileEdges(fs, path, bind_data.httpd_data.parsed_format);
+		state.global_range.Merge(range);
+
+		FlatVector::GetData<string_t>(output.data[0])[output_idx] = StringVector::AddString(output.data[0], path);
+		write_range(range);
+
+		output_idx++;
+		state.current_idx++;
+	}
+
+	// Final row: range over all files (log_file is NULL)
+	if (output_idx < BATCH_SIZE && state.current_idx >= bind_data.files.size() && !state.global_emitted) {
+		FlatVector::SetNull(output.data[0], output_idx, true);
+		write_range(state.global_range);
+		output_idx++;
+		state.global_emitted = true;
+	}
+
+	output.SetCardinality(output_idx);
+}
+
+void HttpdLogTimeRange::RegisterFunction(ExtensionLoader &loader) {
+	TableFunction func("httpd_log_time_range", {LogicalType::VARCHAR}, Function, Bind, Init);
+	func.named_parameters["format_type"] = LogicalType::VARCHAR;
+	func.named_parameters["format_str"] = LogicalType::VARCHAR;
+	func.named_parameters["conf"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(func);
+}
+
+} // namespace duckdb
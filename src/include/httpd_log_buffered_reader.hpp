@@ -1,23 +1,162 @@
 #pragma once
 #include "duckdb/common/file_system.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/storage/buffer/buffer_handle.hpp"
+#include "httpd_log_inflate_cache.hpp"
 
 namespace duckdb {
 
+//! How a scan interacts with the OS page cache (cache_mode option)
+enum class HttpdLogCacheMode : uint8_t {
+	//! Plain buffered reads
+	DEFAULT,
+	//! Hint read-ahead of the next buffer and drop consumed data from the page cache (POSIX_FADV_DONTNEED)
+	DROP_BEHIND,
+	//! Bypass the page cache with direct I/O (uncompressed local files; others fall back to DROP_BEHIND)
+	DIRECT
+};
+
+//! Memory a reader reads file data into
+//! Allocated through DuckDB's buffer manager when one is given, so scans count toward memory_limit
+//! (allocation fails with an out-of-memory error instead of exceeding it)
+class HttpdLogReadBuffer {
+public:
+	HttpdLogReadBuffer() = default;
+	//! alignment: start Ptr() at a multiple of this many bytes (direct I/O); 0 for no requirement
+	HttpdLogReadBuffer(optional_ptr<BufferManager> buffer_manager, idx_t capacity, idx_t alignment = 0);
+	HttpdLogReadBuffer(HttpdLogReadBuffer &&other) noexcept;
+	HttpdLogReadBuffer &operator=(HttpdLogReadBuffer &&other) noexcept;
+
+	char *Ptr() const {
+		return data;
+	}
+	idx_t Capacity() const {
+		return capacity;
+	}
+	bool IsSet() const {
+		return data != nullptr;
+	}
+
+private:
+	BufferHandle handle;              //! Buffer manager allocation
+	unsafe_unique_array<char> memory; //! Untracked allocation (no buffer manager)
+	char *data = nullptr;
+	idx_t capacity = 0;
+};
+
 class HttpdLogBufferedReader {
 public:
-	HttpdLogBufferedReader(FileSystem &fs, const string &path);
+	static constexpr idx_t BUFFER_SIZE = 2097152; // 2MB
+
+	HttpdLogBufferedReader(FileSystem &fs, const string &path, idx_t buffer_capacity = BUFFER_SIZE);
+	//! Read into the given buffer (a fresh one, or one handed back by a previous reader via ReleaseBuffer)
+	//! start_offset: begin reading at this offset instead of the start of the file (requires a seekable file)
+	//! inflate_cache: compressed files take their decompressed blocks from / add them to this cache
+	HttpdLogBufferedReader(FileSystem &fs, const string &path, HttpdLogReadBuffer buffer_p,
+	                       HttpdLogCacheMode cache_mode = HttpdLogCacheMode::DEFAULT, idx_t start_offset = 0,
+	                       shared_ptr<HttpdLogInflateCache> inflate_cache = nullptr);
+	~HttpdLogBufferedReader();
+
+	//! Alignment of buffers, offsets and read sizes required for HttpdLogCacheMode::DIRECT
+	static constexpr idx_t DIRECT_IO_ALIGNMENT = 4096;
 	bool ReadLine(string &result);
 	bool Finished() const;
 
+	//! Consume the rest of the current buffer (refilling once if it is empty) and return the number of lines
+	//! terminated in it. A trailing line without '\n' is counted once EOF is reached. Used by count_mode='lines'.
+	idx_t CountLines();
+
+	//! Skip the rest of the current line (up to and including '\n'); false if EOF was reached first
+	bool SkipLine();
+
+	//! Offset (in the decompressed stream) of the next byte ReadLine will return
+	idx_t GetOffset() const {
+		return buffer_start + buffer_offset;
+	}
+
+	//! Whether Seek() is available (uncompressed file on a seekable file system)
+	bool CanSeek() const {
+		return seekable;
+	}
+
+	//! Continue reading at the given file offset (requires CanSeek())
+	void Seek(idx_t offset);
+
+	//! Size of the file on disk (compressed size for compressed files)
+	idx_t GetFileSize() const;
+
+	idx_t GetBufferCapacity() const {
+		return buffer_capacity;
+	}
+
+	//! Close the file and give up the buffer so the next file scanned by the thread can reuse it
+	HttpdLogReadBuffer ReleaseBuffer();
+
+	//! Whether DuckDB's compression auto-detection will decompress this path (no random access into the text)
+	static bool IsCompressedPath(const string &path);
+
 private:
 	void RefillBuffer();
 
+	//! Read the next buffer_capacity bytes of the stream at buffer_start into the buffer
+	//! With an inflate cache, cached blocks are copied and the stream is only decompressed on a miss
+	idx_t ReadBlock();
+
+	//! Page cache hints (HttpdLogCacheMode::DROP_BEHIND): drop [advised_offset, end) and prefetch what follows
+	void AdviseConsumed(idx_t end);
+	//! Drop whatever is left of the file from the page cache and close the hint descriptor
+	void CloseAdvice();
+
 	unique_ptr<FileHandle> file_handle;
-	static constexpr idx_t BUFFER_SIZE = 2097152; // 2MB
-	unsafe_unique_array<char> buffer;
+	HttpdLogReadBuffer buffer;
+	idx_t buffer_capacity;
+	idx_t buffer_start = 0; //! Stream offset of buffer[0]
 	idx_t buffer_offset = 0;
 	idx_t buffer_size = 0;
 	bool eof_reached = false;
+	bool seekable = false;
+	//! Whether the last byte consumed by CountLines was a newline (or nothing was consumed yet)
+	bool at_line_start = true;
+
+	//! Decompressed blocks of this (compressed) file shared across scans; nullptr when not used
+	shared_ptr<HttpdLogInflateCache> inflate_cache;
+	//! HttpdLogInflateCache::FileIdentity of the file
+	string inflate_file_id;
+	//! Stream offset file_handle has decompressed up to (behind buffer_start after blocks served from the cache)
+	idx_t stream_offset = 0;
+
+	//! Descriptor used only for posix_fadvise hints (-1 when no hints are issued)
+	int advice_fd = -1;
+	//! File offset up to which consumed data has been dropped from the page cache
+	idx_t advised_offset = 0;
+};
+
+//! Reads the lines of a seekable (uncompressed) file from EOF toward the start
+//! Used by reverse=true so that "last N lines" queries can stop early
+class HttpdLogReverseLineReader {
+public:
+	explicit HttpdLogReverseLineReader(unique_ptr<FileHandle> file_handle_p,
+	                                   optional_ptr<BufferManager> buffer_manager = nullptr);
+
+	//! Read the line preceding the previously returned one (empty lines are returned as empty strings)
+	bool ReadLine(string &result);
+
+	//! File offset of the first byte of the line returned by the last ReadLine
+	idx_t GetLineOffset() const {
+		return line_offset;
+	}
+
+private:
+	//! Load the chunk of the file that ends where the current chunk starts
+	void LoadPreviousChunk();
+
+	unique_ptr<FileHandle> file_handle;
+	HttpdLogReadBuffer buffer;
+	idx_t chunk_start = 0; //! File offset of buffer[0]
+	idx_t cursor = 0;      //! Bytes buffer[0, cursor) have not been returned yet
+	string carry;          //! Tail of a line that continues into the following chunk
+	idx_t line_offset = 0; //! File offset of the last returned line
+	bool finished = false;
 };
 
 } // namespace duckdb
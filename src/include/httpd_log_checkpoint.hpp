@@ -0,0 +1,133 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/map.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/common/unordered_set.hpp"
+#include "duckdb/main/client_context_state.hpp"
+
+namespace duckdb {
+
+class Connection;
+
+//! Where the previous checkpointed scan of a file stopped, and how the file looked at that time
+struct HttpdLogFileCheckpoint {
+	//! Inode of the file (local files on POSIX systems; 0 when unknown)
+	idx_t inode = 0;
+	//! Size of the file on disk (compressed size for compressed files)
+	idx_t file_size = 0;
+	//! End of the last complete line read (in the decompressed stream for compressed files)
+	idx_t file_offset = 0;
+	//! Number of lines before file_offset
+	idx_t line_number = 0;
+	//! Hash of the first min(file_offset, HEAD_HASH_SIZE) bytes of the (decompressed) content: recognizes
+	//! a rotated file reusing the name, and a file renamed or compressed by rotation
+	hash_t head_hash = 0;
+};
+
+//! Where a checkpointed scan of a file starts and stops
+struct HttpdLogResumePoint {
+	//! Nothing new to read (compressed file unchanged since its checkpoint)
+	bool unchanged = false;
+	//! Offset in the (decompressed) content; compressed files skip lines up to it
+	idx_t start_offset = 0;
+	//! Line number of the line before start_offset
+	idx_t start_line_number = 0;
+	//! Uncompressed files: end of the last complete line when the file was opened; a partial last line is left
+	//! for the next scan. Compressed files are read to the end.
+	idx_t end_offset = NumericLimits<idx_t>::Maximum();
+	//! Also return the partial last line (up to the size of the file when it was opened); the checkpoint still
+	//! ends at end_offset, so the next scan reads that line again
+	bool read_partial_line = false;
+	//! The file as opened (checkpoint written once it has been read)
+	HttpdLogFileCheckpoint file;
+	//! First HEAD_HASH_SIZE bytes of the content (head_hash of the final checkpoint)
+	string head;
+};
+
+//! Registered on a connection by httpd_log_sync and the result cache (cache_dir): checkpoints of the scans it
+//! runs are collected here and written by the caller in the transaction that inserts the rows
+struct HttpdLogPendingCheckpoints : public ClientContextState {
+	static constexpr const char *KEY = "httpd_log_pending_checkpoints";
+
+	mutex lock;
+	vector<pair<string, HttpdLogFileCheckpoint>> checkpoints;
+	//! Resume a file from the checkpoint of the file it was renamed from; false: only from its own checkpoint
+	//! (the result cache keeps the rows of each file name separately)
+	bool follow_renames = true;
+	//! Return the partial last line of a file too (HttpdLogResumePoint::read_partial_line): the result cache
+	//! has to hold the same rows as a scan without checkpoints
+	bool read_partial_line = false;
+	//! Files read from their start whatever their checkpoint: the caller replaces their rows and checkpoints in
+	//! its transaction, which the scan's checkpoint store does not see yet
+	unordered_set<string> restart_files;
+	//! Files the scans resolved, including the ones without new lines (files_scanned of httpd_log_sync)
+	idx_t files_planned = 0;
+};
+
+//! Registered on the connection of a query with checkpoint_table: the checkpoints of its scans are written when
+//! its transaction commits (right before the commit, through a separate connection), and dropped if it rolls back
+struct HttpdLogTransactionCheckpoints : public ClientContextState {
+	static constexpr const char *KEY = "httpd_log_transaction_checkpoints";
+
+	mutex lock;
+	//! Checkpoints by (quoted) checkpoint table, in the order the files were read
+	map<string, vector<pair<string, HttpdLogFileCheckpoint>>> checkpoints;
+
+	void TransactionCommit(MetaTransaction &transaction, ClientContext &context) override;
+	void TransactionRollback(MetaTransaction &transaction, ClientContext &context) override;
+};
+
+//===--------------------------------------------------------------------===//
+// HttpdLogCheckpointStore - Per-file checkpoints of checkpoint_table
+// The table is read when the scan starts (a missing table has no checkpoints); a file's checkpoint is recorded
+// once the file has been read to its end, and written when the query's transaction commits, which creates the
+// table on first use (HttpdLogTransactionCheckpoints)
+//===--------------------------------------------------------------------===//
+class HttpdLogCheckpointStore {
+public:
+	HttpdLogCheckpointStore(ClientContext &context, const string &table_name);
+	~HttpdLogCheckpointStore();
+
+	//! Bytes at the start of a file hashed into head_hash
+	static constexpr idx_t HEAD_HASH_SIZE = 4096;
+
+	//! head_hash of a file whose content starts with head and is content_size bytes long (or longer)
+	static hash_t HeadHash(const string &head, idx_t content_size);
+
+	//! Quote a table name that may be qualified (schema.table, catalog.schema.table)
+	static string QuoteTableName(const string &table_name);
+
+	//! Create the checkpoint table if it does not exist (table_name already quoted)
+	static void CreateTable(Connection &connection, const string &table_name);
+
+	//! Store checkpoints through the given connection (in its current transaction)
+	static void WriteCheckpoints(Connection &connection, const string &table_name,
+	                             const vector<pair<string, HttpdLogFileCheckpoint>> &checkpoints);
+
+	//! Decide where to resume reading a file: after the checkpoint of the same file, grown or not, or of the
+	//! file it was renamed from (same first bytes); from the start if it is new, or was rotated (other inode or
+	//! other first bytes) or truncated
+	HttpdLogResumePoint Plan(FileSystem &fs, const string &path) const;
+
+	//! Record the checkpoint of a file that has been read to its end
+	void Commit(const string &path, const HttpdLogFileCheckpoint &checkpoint);
+
+private:
+	//! The checkpoint a file resumes from (nullptr: read from the start)
+	optional_ptr<const HttpdLogFileCheckpoint> FindCheckpoint(const string &path, const HttpdLogResumePoint &current,
+	                                                          bool compressed) const;
+
+	unique_ptr<Connection> connection;
+	string table_name;
+	//! Checkpoints of the previous scans, by log_file
+	unordered_map<string, HttpdLogFileCheckpoint> checkpoints;
+	//! Set when running under httpd_log_sync or the result cache: the caller writes the checkpoints
+	shared_ptr<HttpdLogPendingCheckpoints> pending;
+	//! Otherwise: checkpoints written when the query's transaction commits
+	shared_ptr<HttpdLogTransactionCheckpoints> transaction_checkpoints;
+};
+
+} // namespace duckdb
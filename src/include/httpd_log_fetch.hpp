@@ -0,0 +1,48 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "httpd_log_multi_file_info.hpp"
+#include "httpd_log_file_reader.hpp"
+#include "httpd_log_buffered_reader.hpp"
+
+namespace duckdb {
+
+class HttpdLogFetch {
+public:
+	// Register the httpd_log_fetch table function
+	static void RegisterFunction(ExtensionLoader &loader);
+
+private:
+	// Bind data for the table function
+	struct BindData : public TableFunctionData {
+		string path;
+		vector<idx_t> offsets;           // Requested line offsets in file order (duplicates removed)
+		HttpdLogBindData httpd_data;     // Resolved format; raw_mode so that parse_error/raw_line can be written
+		vector<idx_t> schema_column_ids; // Columns of the read_httpd_log schema emitted after file_offset
+	};
+
+	// Global state: one reader positioned at the requested lines in turn
+	struct GlobalState : public GlobalTableFunctionState {
+		unique_ptr<HttpdLogFileReader> column_writer; // Writes values exactly as read_httpd_log does
+		unique_ptr<HttpdLogBufferedReader> line_reader;
+		idx_t next_offset_idx = 0;
+
+		idx_t MaxThreads() const override {
+			return 1;
+		}
+	};
+
+	// Read the line starting at offset; offsets must be increasing across calls
+	static void ReadLineAt(HttpdLogBufferedReader &reader, const string &path, idx_t offset, string &line);
+
+	// Table function operations
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+
+	static unique_ptr<GlobalTableFunctionState> Init(ClientContext &context, TableFunctionInitInput &input);
+
+	static void Function(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+} // namespace duckdb
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "duckdb/common/multi_file/base_file_reader.hpp"
+#include "duckdb/common/optional_idx.hpp"
 #include "duckdb/function/table_function.hpp"
 #include "httpd_log_format_parser.hpp"
 #include "httpd_log_buffered_reader.hpp"
+#include "httpd_log_checkpoint.hpp"
+#include "httpd_log_route.hpp"
 #include <atomic>
 
 namespace duckdb {
@@ -11,6 +14,7 @@ namespace duckdb {
 // Forward declaration
 struct HttpdLogBindData;
 struct HttpdLogGlobalState;
+struct HttpdLogLocalState;
 
 //===--------------------------------------------------------------------===//
 // HttpdLogFileReader - BaseFileReader implementation (like DirectFileReader)
@@ -23,12 +27,68 @@ public:
 	//! The bind data (contains parsed format)
 	const HttpdLogBindData &bind_data;
 
-	//! Buffered reader for the file
+	//! Buffered reader for the file (opened on the first Scan)
 	unique_ptr<HttpdLogBufferedReader> buffered_reader;
 
+	//! Backward reader used instead of buffered_reader when reverse=true and the file is seekable
+	unique_ptr<HttpdLogReverseLineReader> reverse_reader;
+
 	//! Current line number in the file (1-based)
+	//! In reverse mode it counts down from the number of lines in the file
 	idx_t current_line_number = 0;
 
+	//! Byte offset of the current line in the file (in the decompressed stream for compressed files)
+	idx_t current_line_offset = 0;
+
+	//! Virtual columns file_offset and line_number (see HttpdLogMultiFileInfo::GetVirtualColumns)
+	static constexpr column_t COLUMN_IDENTIFIER_FILE_OFFSET = UINT64_C(10000000000000000100);
+	static constexpr column_t COLUMN_IDENTIFIER_LINE_NUMBER = UINT64_C(10000000000000000101);
+	static constexpr column_t COLUMN_IDENTIFIER_ROUTE = UINT64_C(10000000000000000102);
+	//! Number of columns of the schema; columns added after them are virtual columns
+	idx_t schema_column_count = 0;
+	//! Virtual column id of each column added by AddVirtualColumn
+	vector<column_t> virtual_column_ids;
+
+	//! Block sampling (sample=...) is active for this file
+	bool block_sampling = false;
+	//! Chosen blocks of a seekable file, in file order
+	vector<idx_t> sample_blocks;
+	idx_t next_sample_block = 0;
+	//! Lines starting before this offset belong to the current sample block
+	idx_t sample_block_end = 0;
+	//! Compressed/non-seekable files: keep every sample_stride-th block of the stream
+	idx_t sample_stride = 1;
+	//! Stream sampling: lines of the kept block being returned, their offsets and the line number of the first
+	vector<string> stream_lines;
+	vector<idx_t> stream_line_offsets;
+	idx_t stream_first_line_number = 0;
+	idx_t next_stream_line = 0;
+	//! Stream sampling: lines read from the stream, and the first line of the next kept block once read
+	idx_t stream_line_count = 0;
+	optional_idx stream_carry_offset;
+	string stream_carry_line;
+	bool stream_finished = false;
+	//! Fraction of the file actually sampled (sample_fraction column)
+	double sample_fraction = 1.0;
+	//! False when sampling skips parts of the file: line_number is then NULL
+	bool line_numbers_known = true;
+
+	//! checkpoint_table: the scan's checkpoints, and where this file's scan resumes and stops
+	optional_ptr<HttpdLogCheckpointStore> checkpoint_store;
+	HttpdLogResumePoint resume_point;
+
+	//! Rows already counted but not yet emitted (empty-projection scans count faster than they emit)
+	idx_t pending_row_count = 0;
+
+	//! Split scan: a large uncompressed local file is divided into ranges of SPLIT_SIZE bytes, each claimed
+	//! by a thread through TryInitializeScan. Every range is its own batch, so order-preserving sinks
+	//! restore file order (preserve_insertion_order) while the ranges are parsed in parallel.
+	static constexpr idx_t SPLIT_SIZE = 16777216; // 16MB
+	bool split_scan = false;
+	idx_t split_file_size = 0;
+	idx_t range_count = 0;
+	std::atomic<idx_t> next_range {0};
+
 	//! Whether scan has been initialized (TryInitializeScan returned true)
 	//! Thread-safe: atomic for multi-threaded file reading
 	std::atomic<bool> scan_initialized {false};
@@ -48,10 +108,82 @@ public:
 		return "HTTPD_LOG";
 	}
 
-private:
-	//! Write a column value based on schema column ID
+	void AddVirtualColumn(column_t virtual_column_id) override;
+
+	//! assume_sorted=true over several files: this reader emits the merged rows of all files (HttpdLogMerge)
+	bool merge_host = false;
+	//! File of the row being written (log_file column) while merging
+	optional_ptr<const string> merge_row_path;
+
+	//! Whether a file can be split into ranges: plain forward scans of uncompressed local files
+	//! (reverse, sampling and line_number need to read the file from one end; the scan also checks that the
+	//! line_number virtual column is not projected)
+	static bool CanSplit(const HttpdLogBindData &bind_data, const string &path);
+
+	//! Number of ranges a file of the given size is split into
+	static idx_t RangeCount(idx_t file_size);
+
+	//! Compute the "timestamp" column value from the values returned by ParseLogLine
+	//! Returns false if the format has no timestamp column or the value cannot be parsed
+	static bool ExtractTimestamp(const ParsedFormat &parsed_format, const vector<string> &parsed_values,
+	                             timestamp_t &result);
+
+	//! Request path (the "path" column) from the values returned by ParseLogLine
+	//! Returns false if the format has no path column or the request line cannot be parsed
+	static bool ExtractPath(const ParsedFormat &parsed_format, const vector<string> &parsed_values, string &result);
+
+	//! Write a column value based on schema column ID (also used by httpd_log_fetch)
+	//! line_offset is the byte offset of the line (file_offset); split ranges track it per thread
+	//! route_cache memoizes the route column of the calling thread (routes are templated on every row without it)
 	void WriteColumnValue(Vector &vec, idx_t row_idx, idx_t schema_col_id, const vector<string> &parsed_values,
-	                      const string &line, bool parse_error);
+	                      const string &line, bool parse_error, idx_t line_offset,
+	                      optional_ptr<HttpdLogRouteCache> route_cache = nullptr);
+
+private:
+	//! Open the file once the projection is known (reverse reading is pointless when nothing is projected)
+	//! Buffers are taken from / handed back to the thread-local state so consecutive files reuse them
+	//! Files opened ahead in the background (open_ahead) are taken from the global state
+	void OpenReader(ClientContext &context, HttpdLogGlobalState &gstate, HttpdLogLocalState &lstate);
+
+	//! Mark the file as finished, close it and hand the read buffer back to the thread-local state
+	//! With checkpoint_table, the file has been read to its end: store where the next scan resumes
+	void FinishScan(HttpdLogLocalState &lstate);
+
+	//! Read the next line in scan order and update current_line_number
+	bool ReadNextLine(string &line);
+
+	//! Choose the sampled blocks of the file (sample=...)
+	void InitializeSampling();
+
+	//! ReadNextLine for block sampling: only returns lines that start in a sampled block
+	bool ReadNextSampledLine(string &line);
+	//! Stream sampling: read the lines of the next kept block, and the stream on to the next kept block
+	void ReadSampledStreamBlock();
+
+	//! First TryInitializeScan: decide whether the file is split into ranges
+	void PlanSplit(ClientContext &context, const HttpdLogGlobalState &gstate);
+
+	//! Open the range claimed by this thread, positioned at the first line that starts in it
+	void OpenRange(ClientContext &context, HttpdLogLocalState &lstate);
+
+	//! Read the next line of the thread's range (false once the next line starts past the range)
+	bool ReadRangeLine(HttpdLogLocalState &lstate, string &line);
+
+	//! Close the thread's range and hand its read buffer back to the thread-local state
+	void FinishRange(HttpdLogLocalState &lstate);
+
+	//! Scan for assume_sorted over several files: emit the rows of the merge in timestamp order across files
+	void ScanMerge(HttpdLogGlobalState &gstate, HttpdLogLocalState &lstate, DataChunk &output);
+
+	//! Empty projection (e.g. COUNT(*)): produce up to max_rows row-count-only rows without materializing values
+	idx_t ScanRowCount(HttpdLogLocalState &lstate, idx_t max_rows);
+
+	//! Write a virtual column value (file_offset, line_number)
+	void WriteVirtualColumnValue(Vector &vec, idx_t row_idx, column_t virtual_column_id, idx_t line_offset);
+
+	//! Write the route of the request path (route virtual column)
+	void WriteRouteValue(Vector &vec, idx_t row_idx, const vector<string> &parsed_values, bool parse_error,
+	                     optional_ptr<HttpdLogRouteCache> route_cache);
 
 	//! Write a regular field value (non-special columns)
 	void WriteRegularFieldValue(Vector &vec, idx_t row_idx, const FormatField &field, const string &value);
@@ -135,9 +135,11 @@ public:
 	static string GenerateRegexPattern(const ParsedFormat &parsed_format);
 
 	// Generate DuckDB schema (column names and types) from parsed format
-	// Adds standard columns: log_file, and optionally parse_error/raw_line if include_raw_columns=true
+	// Adds standard columns: log_file, optionally sample_fraction if include_sample_column=true,
+	// and optionally line_number/parse_error/raw_line if include_raw_columns=true
 	static void GenerateSchema(const ParsedFormat &parsed_format, vector<string> &names,
-	                           vector<LogicalType> &return_types, bool include_raw_columns = true);
+	                           vector<LogicalType> &return_types, bool include_raw_columns = true,
+	                           bool include_sample_column = false);
 
 	// Parse a log line using the parsed format
 	// Returns a vector of string values corresponding to the fields in parsed_format
@@ -151,6 +153,10 @@ public:
 	// Single-threaded version: uses temporary local buffers (for Bind, DetectFormat)
 	static vector<string> ParseLogLine(const string &line, const ParsedFormat &parsed_format);
 
+	// Check whether a log line would parse, without extracting any submatches
+	// Much cheaper than ParseLogLine (RE2 can answer it with the DFA alone); used when no column is projected
+	static bool MatchLogLine(const string &line, const ParsedFormat &parsed_format);
+
 	// Helper to parse timestamp from Apache log format
 	static bool ParseTimestamp(const string &timestamp_str, timestamp_t &result);
 
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/list.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+namespace duckdb {
+
+//===--------------------------------------------------------------------===//
+// HttpdLogInflateCache - Decompressed blocks of compressed log files, kept across queries
+// Inflating is the largest cost of scanning .gz archives; with httpd_log_inflate_cache_size set, the
+// HttpdLogBufferedReader blocks of compressed files are kept (least recently used first out) and later scans
+// of the same file copy them instead of decompressing again. One cache per database (ObjectCache).
+// Blocks are plain heap allocations: the cache is bounded by its own setting only, outside of memory_limit
+//===--------------------------------------------------------------------===//
+class HttpdLogInflateCache : public ObjectCacheEntry {
+public:
+	//! Setting that bounds the cache (memory size, e.g. '1GB'; '0' disables it)
+	static constexpr const char *SETTING_NAME = "httpd_log_inflate_cache_size";
+
+	//! A decompressed block
+	struct Block {
+		unsafe_unique_array<char> data;
+		idx_t size = 0;
+	};
+
+	//! Register httpd_log_inflate_cache_size
+	static void RegisterSetting(ExtensionLoader &loader);
+
+	//! The cache of the database, resized to the current setting; nullptr when the setting is 0
+	static shared_ptr<HttpdLogInflateCache> Get(ClientContext &context);
+
+	//! Identity of a compressed file: a file rewritten under the same name has another size or modification time
+	static string FileIdentity(FileSystem &fs, FileHandle &handle, const string &path);
+
+	//! The decompressed block of a file starting at stream offset offset (nullptr if it is not cached)
+	shared_ptr<const Block> Lookup(const string &file_id, idx_t offset);
+
+	//! Keep a copy of a decompressed block, evicting the least recently used blocks beyond the capacity
+	void Insert(const string &file_id, idx_t offset, const char *data, idx_t size);
+
+	static string ObjectType() {
+		return "httpd_log_inflate_cache";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+	optional_idx GetEstimatedCacheMemory() const override {
+		return optional_idx(used_bytes);
+	}
+
+private:
+	//! Evict least recently used blocks until the cache fits its capacity (lock held)
+	void Evict();
+
+	mutex lock;
+	idx_t capacity = 0;
+	idx_t used_bytes = 0;
+	//! Most recently used first
+	list<string> lru;
+	struct Entry {
+		shared_ptr<const Block> block;
+		list<string>::iterator position;
+	};
+	unordered_map<string, Entry> blocks;
+};
+
+} // namespace duckdb
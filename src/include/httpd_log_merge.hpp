@@ -0,0 +1,106 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/optional_idx.hpp"
+#include "httpd_log_buffered_reader.hpp"
+
+namespace duckdb {
+
+struct HttpdLogBindData;
+struct HttpdLogLocalState;
+
+//===--------------------------------------------------------------------===//
+// HttpdLogMerge - Rows of several files merged by timestamp (assume_sorted=true)
+// Each file is in timestamp order: a heap holding the next row of each input yields the rows in timestamp order.
+// At most MAX_FAN_IN inputs are read at once, each through a small buffer, so memory does not grow with the
+// number of files: longer file lists are first merged in groups into run files in temp_directory, and the runs
+// are merged in turn (several passes for very long lists).
+//===--------------------------------------------------------------------===//
+class HttpdLogMerge {
+public:
+	//! Inputs read at once by one merge
+	static constexpr idx_t MAX_FAN_IN = 64;
+	//! Read buffer of each input: a merge only needs the next few lines of each
+	static constexpr idx_t INPUT_BUFFER_SIZE = 65536; // 64KB
+	//! Run files are written in pieces of this size
+	static constexpr idx_t RUN_WRITE_SIZE = 1048576; // 1MB
+
+	//! A row of the merge
+	struct Row {
+		//! Index of the row's file in the merged files
+		idx_t file_idx = 0;
+		idx_t line_number = 0;
+		idx_t line_offset = 0;
+		//! Rows without a timestamp (parse errors in raw mode) keep the previous timestamp of their file
+		timestamp_t timestamp = timestamp_t::ninfinity();
+		string line;
+		vector<string> parsed_values;
+		bool parse_error = false;
+	};
+
+	HttpdLogMerge(ClientContext &context, const HttpdLogBindData &bind_data, vector<string> files);
+	~HttpdLogMerge();
+
+	//! The next row in timestamp order (rows with equal timestamps in file order); nullptr once all rows were read
+	//! The row stays valid until the next call; lstate provides the parsing buffers
+	optional_ptr<const Row> Next(HttpdLogLocalState &lstate);
+
+	//! Path of a merged file (Row::file_idx)
+	const string &GetPath(idx_t file_idx) const {
+		return files[file_idx];
+	}
+
+private:
+	//! What an input reads: a log file (file_idx set) or a run file written by an earlier pass
+	struct InputSource {
+		string path;
+		optional_idx file_idx;
+	};
+
+	//! An input of a merge with its next row
+	struct Input {
+		unique_ptr<HttpdLogBufferedReader> reader;
+		optional_idx file_idx;
+		Row row;
+	};
+
+	//! One k-way merge of up to MAX_FAN_IN inputs
+	struct Pass {
+		vector<Input> inputs;
+		//! Indexes of the inputs with a pending row, earliest row on top
+		vector<idx_t> heap;
+		//! Input of the row returned last: advanced on the next call
+		optional_idx current;
+		//! Run inputs are parsed (final pass); earlier passes copy their lines as they are
+		bool parse_runs = false;
+	};
+
+	//! Open the inputs of a pass and read their first rows
+	void OpenPass(Pass &pass, const vector<InputSource> &sources, bool parse_runs, HttpdLogLocalState &lstate);
+
+	//! Read the next row of an input; false at its end
+	bool AdvanceInput(Input &input, bool parse_runs, HttpdLogLocalState &lstate);
+
+	//! The next row of a pass (nullptr at its end)
+	optional_ptr<const Row> NextRow(Pass &pass, HttpdLogLocalState &lstate);
+
+	//! Merge a group of inputs into a new run file; returns its path
+	string WriteRun(const vector<InputSource> &group, HttpdLogLocalState &lstate);
+
+	//! Merge the files in groups until at most MAX_FAN_IN inputs are left, and open the final pass on them
+	void Initialize(HttpdLogLocalState &lstate);
+
+	FileSystem &fs;
+	BufferManager &buffer_manager;
+	string temp_directory;
+	const HttpdLogBindData &bind_data;
+	vector<string> files;
+
+	bool initialized = false;
+	Pass final_pass;
+	//! Run files not deleted yet
+	vector<string> runs;
+};
+
+} // namespace duckdb
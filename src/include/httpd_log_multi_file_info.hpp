@@ -1,10 +1,29 @@
 #pragma once
 
 #include "duckdb/common/multi_file/multi_file_function.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/common/unordered_set.hpp"
 #include "httpd_log_format_parser.hpp"
+#include "httpd_log_buffered_reader.hpp"
+#include "httpd_log_checkpoint.hpp"
+#include "httpd_log_merge.hpp"
+#include "httpd_log_route.hpp"
+#include <atomic>
+#include <future>
 
 namespace duckdb {
 
+//! Byte-identical files in the file list (skip_duplicates option)
+enum class HttpdLogDuplicateMode : uint8_t {
+	//! Scan every file
+	NONE,
+	//! Skip files with the same size and the same first and last blocks as an earlier file
+	FINGERPRINT,
+	//! FINGERPRINT, confirmed by a hash of the whole content
+	CONTENT
+};
+
 //===--------------------------------------------------------------------===//
 // HttpdLogFileReaderOptions - Options for the reader
 //===--------------------------------------------------------------------===//
@@ -14,6 +33,18 @@ public:
 	string format_str;
 	string conf;
 	bool raw_mode = false;
+	bool count_lines = false; // count_mode='lines': COUNT(*) counts newlines without parsing
+	bool reverse = false;     // reverse=true: read seekable files from the last line to the first
+	bool sampling = false;    // sample=<fraction>: parse only a sample of blocks
+	double sample_rate = 1.0;
+	int64_t sample_seed = -1; // -1: random
+	int64_t open_ahead = -1;  // files opened in the background ahead of the scan; -1: auto (remote files only)
+	HttpdLogCacheMode cache_mode = HttpdLogCacheMode::DEFAULT; // cache_mode: page cache behaviour
+	bool assume_sorted = false; // assume_sorted=true: each file is in timestamp order, merge files by timestamp
+	string checkpoint_table;    // checkpoint_table=<name>: only read lines added since the previous scan
+	HttpdLogDuplicateMode skip_duplicates = HttpdLogDuplicateMode::NONE; // skip_duplicates: identical files
+	string filename_time_pattern; // filename_time_pattern=<strftime>: prune files by the time in their name
+	Value route_rules;            // route_rules=MAP {regex: rewrite}: route templates tried before segment replacement
 };
 
 //===--------------------------------------------------------------------===//
@@ -25,6 +56,61 @@ struct HttpdLogBindData : public TableFunctionData {
 	string conf;
 	ParsedFormat parsed_format;
 	bool raw_mode = false;
+	bool count_lines = false;
+	bool reverse = false;
+	bool sampling = false;
+	double sample_rate = 1.0;
+	int64_t sample_seed = -1;
+	int64_t open_ahead = -1;
+	HttpdLogCacheMode cache_mode = HttpdLogCacheMode::DEFAULT;
+	bool assume_sorted = false;
+	string checkpoint_table;
+	HttpdLogDuplicateMode skip_duplicates = HttpdLogDuplicateMode::NONE;
+	//! Time in the file names (%Y %m %d %H %M %S); files outside the timestamp filters are not read
+	string filename_time_pattern;
+	//! Rules of the route column, tried in order before numeric, UUID and hex segments are replaced
+	vector<HttpdLogRouteRule> route_rules;
+	//! Schema generated once at bind time and shared by all file readers
+	vector<string> schema_names;
+	vector<LogicalType> schema_types;
+};
+
+//===--------------------------------------------------------------------===//
+// HttpdLogOpenAhead - Opens the next files of the scan in the background
+// Opening a file and reading its first buffer can take tens of milliseconds on network
+// file systems; this overlaps it with parsing the files before it
+//===--------------------------------------------------------------------===//
+class HttpdLogOpenAhead {
+public:
+	HttpdLogOpenAhead(FileSystem &fs, BufferManager &buffer_manager, shared_ptr<MultiFileList> file_list,
+	                  idx_t window, HttpdLogCacheMode cache_mode, shared_ptr<HttpdLogInflateCache> inflate_cache);
+
+	//! Take the reader for a file if it was opened ahead (nullptr otherwise; the caller then opens it itself)
+	//! and start opening the next files, keeping at most window files ahead of the files taken so far
+	//! No file is opened ahead while the buffer manager is close to memory_limit
+	unique_ptr<HttpdLogBufferedReader> Take(const string &path);
+
+	//! Files handed to readers already opened (EXPLAIN ANALYZE)
+	idx_t FilesOpenedAhead() const {
+		return files_opened_ahead;
+	}
+
+private:
+	FileSystem &fs;
+	BufferManager &buffer_manager;
+	shared_ptr<MultiFileList> file_list;
+	idx_t window;
+	HttpdLogCacheMode cache_mode;
+	shared_ptr<HttpdLogInflateCache> inflate_cache;
+
+	mutex lock;
+	idx_t files_taken = 0;
+	idx_t next_file_idx = 0;
+	//! Files being opened in the background
+	unordered_map<string, std::future<unique_ptr<HttpdLogBufferedReader>>> pending;
+	//! Files already opened by a reader (never opened ahead)
+	unordered_set<string> taken;
+	std::atomic<idx_t> files_opened_ahead {0};
 };
 
 //===--------------------------------------------------------------------===//
@@ -32,6 +118,20 @@ struct HttpdLogBindData : public TableFunctionData {
 //===--------------------------------------------------------------------===//
 struct HttpdLogGlobalState : public GlobalTableFunctionState {
 	vector<idx_t> column_ids;
+	//! Background opening of upcoming files (open_ahead); nullptr when disabled
+	unique_ptr<HttpdLogOpenAhead> open_ahead;
+	//! Single-file scans: number of ranges the file is split into (threads that can work on it)
+	idx_t single_file_ranges = 1;
+	//! The line_number virtual column is projected: files are read from their start and never split
+	bool line_number_projected = false;
+	//! checkpoint_table: where each file's previous scan stopped; nullptr when not set
+	unique_ptr<HttpdLogCheckpointStore> checkpoints;
+	//! Decompressed blocks of compressed files kept across queries (httpd_log_inflate_cache_size); nullptr when off
+	shared_ptr<HttpdLogInflateCache> inflate_cache;
+	//! assume_sorted=true over several files: the rows of all files merged by timestamp; nullptr otherwise
+	//! The first reader scanned hosts the merge (merge_claimed), the readers of the other files produce no rows
+	unique_ptr<HttpdLogMerge> merge;
+	bool merge_claimed = false;
 };
 
 //===--------------------------------------------------------------------===//
@@ -44,6 +144,24 @@ struct HttpdLogLocalState : public LocalTableFunctionState {
 	vector<duckdb_re2::RE2::Arg> args;
 	vector<duckdb_re2::RE2::Arg *> arg_ptrs;
 
+	//! Read buffer handed back by the last file this thread finished, reused by the next one
+	//! (with many small files, allocating a fresh 2MB buffer per file dominates the scan)
+	HttpdLogReadBuffer spare_buffer;
+
+	//! Range of a split file (see HttpdLogFileReader::SPLIT_SIZE) claimed by this thread in TryInitializeScan
+	//! Lines are assigned to the range their first byte is in
+	bool range_active = false;
+	idx_t range_start = 0;
+	idx_t range_end = 0;
+	unique_ptr<HttpdLogBufferedReader> range_reader;
+	//! Rows counted but not yet emitted (empty projection)
+	idx_t range_pending_rows = 0;
+	//! Byte offset of the last line read from the range (file_offset)
+	idx_t range_line_offset = 0;
+
+	//! Routes of the paths this thread has written (route column)
+	HttpdLogRouteCache route_cache;
+
 	//! Initialize buffers for the given number of capturing groups
 	void InitializeBuffers(int num_groups) {
 		if (matches.size() != static_cast<size_t>(num_groups)) {
@@ -63,6 +181,10 @@ struct HttpdLogLocalState : public LocalTableFunctionState {
 struct HttpdLogMultiFileInfo : MultiFileReaderInterface {
 	static unique_ptr<MultiFileReaderInterface> CreateInterface(ClientContext &context);
 
+	//! Resolve parsed_format/format_type/format_str from the options in httpd_data
+	//! (format_str, conf, format_type or auto-detection on sample lines of file_list)
+	static void BindFormat(ClientContext &context, HttpdLogBindData &httpd_data, MultiFileList &file_list);
+
 	unique_ptr<BaseFileReaderOptions> InitializeOptions(ClientContext &context,
 	                                                    optional_ptr<TableFunctionInfo> info) override;
 
@@ -100,6 +222,26 @@ struct HttpdLogMultiFileInfo : MultiFileReaderInterface {
 	                                        const MultiFileOptions &file_options) override;
 
 	unique_ptr<NodeStatistics> GetCardinality(const MultiFileBindData &bind_data, idx_t file_count) override;
+
+	//! file_offset and line_number, computed only when projected (line_number is a regular column in raw mode)
+	void GetVirtualColumns(ClientContext &context, MultiFileBindData &bind_data, virtual_column_map_t &result) override;
+
+	//! Complex filter pushdown (pushdown_complex_filter): with filename_time_pattern, files whose name places them
+	//! outside the range of the filters on timestamp are dropped before any file is opened; then the
+	//! multi-file reader's own pruning (hive partitions, filename)
+	static void PushdownComplexFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data,
+	                                  vector<unique_ptr<Expression>> &filters);
+
+	//! Partition information (get_partition_info): every batch comes from one file, so log_file has a single
+	//! value per batch and GROUP BY log_file can use partitioned aggregation. Other columns are left to
+	//! the multi-file reader (hive partitions).
+	static TablePartitionInfo GetPartitionInfo(ClientContext &context, TableFunctionPartitionInput &input);
+
+	//! Batch index and, when partitioning on log_file, the file of the batch (get_partition_data)
+	static OperatorPartitionData GetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input);
+
+	//! EXPLAIN ANALYZE details (dynamic_to_string): the multi-file reader's, and the files opened ahead
+	static InsertionOrderPreservingMap<string> DynamicToString(TableFunctionDynamicToStringInput &input);
 };
 
 } // namespace duckdb
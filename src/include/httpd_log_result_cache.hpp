@@ -0,0 +1,25 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/parser/tableref.hpp"
+
+namespace duckdb {
+
+//===--------------------------------------------------------------------===//
+// HttpdLogResultCache - Parsed rows of log files kept in a DuckDB database (cache_dir)
+// read_httpd_log(..., cache_dir=...) is replaced by a scan of the cached rows, so projection and filter
+// pushdown work as on any table. Files that are new or changed since they were cached are parsed into the
+// cache first (when the query is bound); files that only grew get their new lines appended (see
+// HttpdLogCheckpointStore). The cache database is detached again once the queries reading it have ended
+//===--------------------------------------------------------------------===//
+class HttpdLogResultCache {
+public:
+	//! Database file created in cache_dir
+	static constexpr const char *CACHE_FILE_NAME = "httpd_log_cache.duckdb";
+
+	//! bind_replace of read_httpd_log: nullptr (regular scan) when cache_dir is not set
+	static unique_ptr<TableRef> BindReplace(ClientContext &context, TableFunctionBindInput &input);
+};
+
+} // namespace duckdb
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "re2/re2.h"
+
+namespace duckdb {
+
+//! A route_rules entry: a path matching pattern is rewritten with rewrite (\1 to \9 refer to groups)
+struct HttpdLogRouteRule {
+	shared_ptr<duckdb_re2::RE2> pattern;
+	string rewrite;
+};
+
+//===--------------------------------------------------------------------===//
+// HttpdLogRoute - Route templates of request paths (route column)
+// /users/123/orders/98765 becomes /users/{id}/orders/{id}: the route of a path is the rewrite of the first
+// matching route_rules entry, otherwise the path with numeric, UUID and hex segments replaced
+//===--------------------------------------------------------------------===//
+class HttpdLogRoute {
+public:
+	//! Compile route_rules (MAP of regex to rewrite, applied in order); BinderException for invalid entries
+	static vector<HttpdLogRouteRule> ParseRules(const Value &rules);
+
+	//! Route of a path
+	static string Template(const vector<HttpdLogRouteRule> &rules, const string &path);
+
+	//! Path with numeric segments replaced by {id}, UUIDs by {uuid} and hex strings by {hex}
+	static string ReplaceSegments(const string &path);
+};
+
+//===--------------------------------------------------------------------===//
+// HttpdLogRouteCache - Routes of the paths a thread has seen (HttpdLogLocalState)
+// Requests repeat the same paths: a path is templated once per thread. The cache is emptied when it holds
+// CACHE_SIZE paths, so scans over many unique paths use bounded memory
+//===--------------------------------------------------------------------===//
+class HttpdLogRouteCache {
+public:
+	static constexpr idx_t CACHE_SIZE = 16384;
+
+	const string &Get(const vector<HttpdLogRouteRule> &rules, const string &path);
+
+private:
+	unordered_map<string, string> routes;
+};
+
+} // namespace duckdb
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/deque.hpp"
+#include "duckdb/common/map.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/connection.hpp"
+
+namespace duckdb {
+
+class HttpdLogSessions {
+public:
+	// Register the httpd_log_sessions table function
+	static void RegisterFunction(ExtensionLoader &loader);
+
+private:
+	// Bind data for the table function
+	struct BindData : public TableFunctionData {
+		string path_pattern;
+		string scan_options;         // Format options passed on to read_httpd_log
+		vector<string> key_columns;  // Columns identifying a visitor (default: client_host, user_agent)
+		vector<LogicalType> key_types;
+		int64_t gap_micros;          // Inactivity that ends a session
+		int64_t out_of_order_micros; // How far a line may lag behind the newest line seen
+		bool has_bytes = false;
+		bool has_path = false;
+	};
+
+	// A session: consecutive requests of one key, no more than gap apart
+	struct Session {
+		idx_t id = 0; // Order in which sessions were opened (orders sessions ending at the same time)
+		vector<Value> key;
+		timestamp_t start;
+		timestamp_t end;
+		int64_t hits = 0;
+		int64_t bytes = 0;
+		string entry_path;
+		string exit_path;
+	};
+
+	// Hash and equality of the key values of a visitor (NULL values are equal to each other)
+	struct KeyHash {
+		size_t operator()(const vector<Value> &key) const;
+	};
+	struct KeyEquality {
+		bool operator()(const vector<Value> &a, const vector<Value> &b) const;
+	};
+
+	// Global state: the lines stream in timestamp order from a nested scan; only open sessions are kept
+	struct GlobalState : public GlobalTableFunctionState {
+		unique_ptr<Connection> connection;
+		unique_ptr<QueryResult> scan;
+		bool scan_finished = false;
+		unordered_map<vector<Value>, Session, KeyHash, KeyEquality> open_sessions;
+		map<pair<timestamp_t, idx_t>, Session *> open_by_end; // Open sessions by their last request (and id)
+		idx_t next_session_id = 0;
+		deque<Session> closed_sessions; // Waiting to be emitted
+		timestamp_t newest = timestamp_t(NumericLimits<int64_t>::Minimum()); // Newest line seen so far
+
+		idx_t MaxThreads() const override {
+			return 1;
+		}
+	};
+
+	// Add a line to its session, closing the previous session of the key when the gap is exceeded
+	static void AddLine(const BindData &bind_data, GlobalState &state, const vector<Value> &key, timestamp_t timestamp,
+	                    int64_t bytes, const string &path);
+
+	// Close the sessions whose gap has passed, allowing for lines out of order by up to out_of_order
+	static void CloseExpiredSessions(const BindData &bind_data, GlobalState &state);
+
+	// Table function operations
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+
+	static unique_ptr<GlobalTableFunctionState> Init(ClientContext &context, TableFunctionInitInput &input);
+
+	static void Function(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+} // namespace duckdb
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/map.hpp"
+
+namespace duckdb {
+
+//===--------------------------------------------------------------------===//
+// HttpdLogHll - HyperLogLog sketch of distinct values (e.g. client_ip)
+// 4096 registers: about 1.6% standard error; sketches of the same values merge exactly
+//===--------------------------------------------------------------------===//
+class HttpdLogHll {
+public:
+	static constexpr uint8_t PRECISION = 12;
+	static constexpr idx_t REGISTER_COUNT = idx_t(1) << PRECISION;
+
+	HttpdLogHll() : registers(REGISTER_COUNT, 0) {
+	}
+
+	void Add(hash_t hash);
+	void Merge(const HttpdLogHll &other);
+	//! Estimated number of distinct values
+	idx_t Estimate() const;
+
+	string Serialize() const;
+	//! Throws InvalidInputException for a blob that is not a serialized HttpdLogHll
+	static HttpdLogHll Deserialize(const string_t &blob);
+
+private:
+	vector<uint8_t> registers;
+};
+
+//===--------------------------------------------------------------------===//
+// HttpdLogDDSketch - DDSketch of a distribution (e.g. duration, bytes)
+// Quantiles are within 1% of the true value; values are counted in logarithmic bins, the bins of the smallest
+// magnitudes are collapsed beyond MAX_BINS
+//===--------------------------------------------------------------------===//
+class HttpdLogDDSketch {
+public:
+	static constexpr double RELATIVE_ACCURACY = 0.01;
+	static constexpr idx_t MAX_BINS = 2048;
+	//! Magnitudes below this are counted as zero
+	static constexpr double MIN_MAGNITUDE = 1e-9;
+
+	void Add(double value);
+	void Merge(const HttpdLogDDSketch &other);
+	//! Value at quantile q (0 to 1) of the values added
+	double Quantile(double q) const;
+
+	string Serialize() const;
+	//! Throws InvalidInputException for a blob that is not a serialized HttpdLogDDSketch
+	static HttpdLogDDSketch Deserialize(const string_t &blob);
+
+private:
+	static int32_t BinIndex(double magnitude);
+	static double BinValue(int32_t index);
+	static void Collapse(map<int32_t, uint64_t> &bins);
+
+	//! Bins by magnitude (negative values are kept by their magnitude)
+	map<int32_t, uint64_t> positive;
+	map<int32_t, uint64_t> negative;
+	uint64_t zero_count = 0;
+	uint64_t count = 0;
+};
+
+//===--------------------------------------------------------------------===//
+// HttpdLogSketch - SQL functions over the sketches
+// httpd_log_hll / httpd_log_ddsketch aggregate values into a serialized sketch (BLOB); the _merge aggregates
+// combine stored sketches (e.g. hourly partials), httpd_log_hll_estimate / httpd_log_ddsketch_quantile query them
+//===--------------------------------------------------------------------===//
+class HttpdLogSketch {
+public:
+	static void RegisterFunctions(ExtensionLoader &loader);
+};
+
+} // namespace duckdb
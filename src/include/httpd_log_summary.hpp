@@ -0,0 +1,20 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/parser/tableref.hpp"
+
+namespace duckdb {
+
+class HttpdLogSummary {
+public:
+	// Register the httpd_log_summary table function
+	static void RegisterFunction(ExtensionLoader &loader);
+
+private:
+	// httpd_log_summary is replaced by a grouped scan of read_httpd_log: only the timestamp, status, bytes and
+	// grouping columns are produced by the scan, and each thread aggregates into its own hash table
+	static unique_ptr<TableRef> BindReplace(ClientContext &context, TableFunctionBindInput &input);
+};
+
+} // namespace duckdb
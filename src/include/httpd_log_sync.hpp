@@ -0,0 +1,40 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/function/table_function.hpp"
+
+namespace duckdb {
+
+class HttpdLogSync {
+public:
+	// Register the httpd_log_sync table function
+	static void RegisterFunction(ExtensionLoader &loader);
+
+private:
+	// Bind data for the table function
+	struct BindData : public TableFunctionData {
+		string table_name;     // Target table, fully qualified (created from the scan's schema if it does not exist)
+		string path_pattern;   // Files to ingest
+		string state_table;    // checkpoint_table of the scan, fully qualified (default: <table>_sync_state)
+		string format_options; // Format options passed on to read_httpd_log
+	};
+
+	// Global state: the sync runs once and reports a single row
+	struct GlobalState : public GlobalTableFunctionState {
+		bool done = false;
+
+		idx_t MaxThreads() const override {
+			return 1;
+		}
+	};
+
+	// Table function operations
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+
+	static unique_ptr<GlobalTableFunctionState> Init(ClientContext &context, TableFunctionInitInput &input);
+
+	static void Function(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+} // namespace duckdb
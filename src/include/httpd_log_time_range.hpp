@@ -0,0 +1,57 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "httpd_log_multi_file_info.hpp"
+
+namespace duckdb {
+
+class HttpdLogTimeRange {
+public:
+	// Register the httpd_log_time_range table function
+	static void RegisterFunction(ExtensionLoader &loader);
+
+	// Timestamp range observed in a file
+	struct TimeRange {
+		bool has_value = false;
+		timestamp_t min_ts;
+		timestamp_t max_ts;
+
+		void Update(timestamp_t ts);
+		void Merge(const TimeRange &other);
+	};
+
+	// Determine the timestamp range of a file from its first and last lines only
+	// Uncompressed seekable files read a small window at each end; compressed files are streamed
+	// but only the edge lines are parsed
+	static TimeRange ScanFileEdges(FileSystem &fs, const string &path, const ParsedFormat &parsed_format);
+
+private:
+	// Bind data for the table function
+	struct BindData : public TableFunctionData {
+		vector<OpenFileInfo> files;
+		HttpdLogBindData httpd_data; // Resolved format (format_str, conf, format_type or auto-detection)
+	};
+
+	// Global state for iterating through files
+	struct GlobalState : public GlobalTableFunctionState {
+		idx_t current_idx = 0;
+		TimeRange global_range;     // Range over all files (emitted as the final row)
+		bool global_emitted = false;
+
+		idx_t MaxThreads() const override {
+			return 1;
+		}
+	};
+
+	// Table function operations
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+
+	static unique_ptr<GlobalTableFunctionState> Init(ClientContext &context, TableFunctionInitInput &input);
+
+	static void Function(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+} // namespace duckdb